@@ -28,7 +28,12 @@
 
 #include "Memory.h"
 #include "Macros.h"
+#include "Profile.h"
+#include "Result.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 
 struct MemoryBlock
@@ -37,17 +42,137 @@ struct MemoryBlock
 	size_t	 Size;
 };
 
+/**
+ * @brief A null Ptr marks the error, which is then kept in Size, so Expected<MemoryBlock> stays two registers wide.
+ *
+ */
+template<typename TError>
+struct ExpectedStorage<MemoryBlock, TError>
+{
+	static_assert(sizeof(TError) <= sizeof(size_t), "Error type doesn't fit in MemoryBlock::Size.");
+
+	MemoryBlock Value;
+
+	ExpectedStorage(const MemoryBlock& Data) : Value{Data}
+	{
+		assert(Data.Ptr && "Expected<MemoryBlock> values need a non null Ptr.");
+	}
+	ExpectedStorage(ExpectedErrorTag, const TError Error) : Value{nullptr, ToSize(Error)}
+	{
+	}
+	[[nodiscard]] bool HasValue() const
+	{
+		return Value.Ptr != nullptr;
+	}
+	[[nodiscard]] TError Error() const
+	{
+		if (Value.Ptr)
+			return ResultTraits<TError>::OK;
+		if constexpr (std::is_pointer_v<TError>)
+			return reinterpret_cast<TError>(Value.Size);
+		else
+			return static_cast<TError>(Value.Size);
+	}
+
+private:
+	static size_t ToSize(const TError Error)
+	{
+		if constexpr (std::is_pointer_v<TError>)
+			return reinterpret_cast<size_t>(Error);
+		else
+			return static_cast<size_t>(Error);
+	}
+};
+
 static constexpr size_t RoundToAligned(size_t Size, size_t Alignment = sizeof(std::max_align_t))
 {
 	return ((Size + (Alignment - 1)) & ~(Alignment - 1));
 }
 
+static constexpr bool IsPowerOfTwo(size_t Value)
+{
+	return Value && !(Value & (Value - 1));
+}
+
+BC_INLINE bool IsAligned(const void* Ptr, size_t Alignment)
+{
+	return (reinterpret_cast<uintptr_t>(Ptr) & (Alignment - 1)) == 0;
+}
+
+// MAX_ALIGNMENT of allocators honoring any power of two alignment.
+static constexpr size_t ALIGNMENT_ANY = ~(~size_t{0} >> 1);
+
+/**
+ * @brief Largest alignment TAllocator guarantees, its MAX_ALIGNMENT or the malloc one, alignof(std::max_align_t).
+ *
+ */
+template<typename TAllocator, typename = void>
+struct AllocatorMaxAlignment: std::integral_constant<size_t, alignof(std::max_align_t)>
+{
+};
+
+template<typename TAllocator>
+struct AllocatorMaxAlignment<TAllocator, std::void_t<decltype(TAllocator::MAX_ALIGNMENT)>>
+	: std::integral_constant<size_t, TAllocator::MAX_ALIGNMENT>
+{
+};
+
+// Scavenge clock, milliseconds on the steady clock offset by one so zero can mean "not idle".
+static uint64_t ScavengeTimestamp(const std::chrono::steady_clock::time_point Now)
+{
+	const auto lMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(Now.time_since_epoch());
+	return static_cast<uint64_t>(lMilliseconds.count()) + 1;
+}
+
+// Counters written by a single thread and read from others, a relaxed load and store avoid a locked instruction.
+template<typename T>
+BC_INLINE T SingleWriterAdd(std::atomic<T>& Counter, const T Value)
+{
+	const T lValue = Counter.load(std::memory_order_relaxed) + Value;
+	Counter.store(lValue, std::memory_order_relaxed);
+	return lValue;
+}
+
+template<typename T>
+BC_INLINE T SingleWriterSub(std::atomic<T>& Counter, const T Value)
+{
+	const T lValue = Counter.load(std::memory_order_relaxed) - Value;
+	Counter.store(lValue, std::memory_order_relaxed);
+	return lValue;
+}
+
+static constexpr size_t RoundToPowerOfTwo(size_t Value)
+{
+	size_t lResult = 1;
+	while (lResult < Value)
+		lResult <<= 1;
+	return lResult;
+}
+
+/**
+ * @brief Allocates from any allocator reporting failure as ResultErrorNotEnoughMemory instead of a null block.
+ *
+ */
+template<typename TAllocator>
+BC_INLINE Expected<MemoryBlock> TryAllocate(TAllocator& Allocator, size_t Size,
+											size_t Alignment = alignof(std::max_align_t))
+{
+	const MemoryBlock lMemoryBlock = Allocator.Allocate(Size, Alignment);
+	RESULT_RETURN_CHECK(!lMemoryBlock.Ptr, ResultErrorNotEnoughMemory);
+	return lMemoryBlock;
+}
+
 template<typename TFirstAllocator, typename TSecondAllocator>
 class FallbackAllocator: private TFirstAllocator, private TSecondAllocator
 {
 public:
-	MemoryBlock Allocate(size_t Size, size_t Alignment = sizeof(std::max_align_t))
+	static constexpr size_t MAX_ALIGNMENT = std::min(AllocatorMaxAlignment<TFirstAllocator>::value,
+													 AllocatorMaxAlignment<TSecondAllocator>::value);
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
 	{
+		BC_PROFILE_SCOPE("FallbackAllocator::Allocate");
 		MemoryBlock lMemoryBlock = TFirstAllocator::Allocate(Size, Alignment);
 		if (!lMemoryBlock.Ptr)
 			lMemoryBlock = TSecondAllocator::Allocate(Size, Alignment);
@@ -56,6 +181,7 @@ public:
 
 	void Deallocate(MemoryBlock& Mb)
 	{
+		BC_PROFILE_SCOPE("FallbackAllocator::Deallocate");
 		if (TFirstAllocator::Owns(Mb))
 			TFirstAllocator::Deallocate(Mb);
 		else
@@ -69,18 +195,85 @@ public:
 	}
 };
 
+inline constexpr char PROFILE_ALLOCATOR_NAME[] = "Allocator";
+
+/**
+ * @brief Allocator wrapper emitting a zone per Allocate/Deallocate and a live bytes counter, both named Name.
+ *
+ * Wrap the tier to observe, e.g. PoolAllocator<64, ProfiledAllocator<Mallocator, gPoolName>>, and its time and
+ * footprint show up on the same timeline as the frame zones. Only the live bytes count remains when profiling is
+ * compiled out.
+ *
+ */
+template<typename TAllocator, const char* Name = PROFILE_ALLOCATOR_NAME>
+class ProfiledAllocator: private TAllocator
+{
+	int64_t mLiveBytes{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = AllocatorMaxAlignment<TAllocator>::value;
+
+public:
+	using TAllocator::TAllocator;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		BC_PROFILE_SCOPE(Name);
+		MemoryBlock lMemoryBlock = TAllocator::Allocate(Size, Alignment);
+		mLiveBytes += static_cast<int64_t>(lMemoryBlock.Size);
+		BC_PROFILE_COUNTER(Name, mLiveBytes);
+		return lMemoryBlock;
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		BC_PROFILE_SCOPE(Name);
+		mLiveBytes -= static_cast<int64_t>(Mb.Size);
+		TAllocator::Deallocate(Mb);
+		BC_PROFILE_COUNTER(Name, mLiveBytes);
+		Mb = {};
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return TAllocator::Owns(Mb);
+	}
+
+	[[nodiscard]] int64_t LiveBytes() const
+	{
+		return mLiveBytes;
+	}
+};
+
 class Mallocator
 {
 public:
-	MemoryBlock Allocate(size_t Size, size_t Alignment = sizeof(std::max_align_t))
+	static constexpr size_t MAX_ALIGNMENT = ALIGNMENT_ANY;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
 	{
-		UNUSED(Alignment);
-		return MemoryBlock{static_cast<uint8_t*>(malloc(Size)), Size};
+		assert(IsPowerOfTwo(Alignment) && "Invalid alignment.");
+#if _WIN32
+		return MemoryBlock{static_cast<uint8_t*>(_aligned_malloc(Size, Alignment)), Size};
+#else
+		if (Alignment <= alignof(std::max_align_t))
+			return MemoryBlock{static_cast<uint8_t*>(malloc(Size)), Size};
+		void* lPtr = nullptr;
+		if (posix_memalign(&lPtr, Alignment < sizeof(void*) ? sizeof(void*) : Alignment, Size) != 0)
+			return MemoryBlock{};
+		return MemoryBlock{static_cast<uint8_t*>(lPtr), Size};
+#endif
 	}
 
 	void Deallocate(MemoryBlock& Mb)
 	{
+#if _WIN32
+		_aligned_free(Mb.Ptr);
+#else
 		free(Mb.Ptr);
+#endif
 		Mb = {};
 	}
 
@@ -90,10 +283,14 @@ public:
 	}
 };
 
+#if _WIN32
 class WindowsMallocator
 {
 public:
-	MemoryBlock Allocate(size_t Size, size_t Alignment = sizeof(std::max_align_t))
+	static constexpr size_t MAX_ALIGNMENT = ALIGNMENT_ANY;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
 	{
 		return MemoryBlock{static_cast<uint8_t*>(_aligned_malloc(Size, Alignment)), Size};
 	}
@@ -110,172 +307,1418 @@ public:
 	}
 };
 
-#if _WIN32
 using platform_mallocator_t = WindowsMallocator;
 #endif
 
-template<size_t N>
-class StackAllocator
+/**
+ * @brief Cumulative bytes mapped by HugePageAllocator for each backing it ended up with.
+ *
+ */
+struct HugePageStats
 {
-	uint8_t	 mData[N] = {};
-	uint8_t *mCursor{}, *mEnd{};
+	std::atomic<uint64_t> ExplicitBytes{};
+	std::atomic<uint64_t> TransparentBytes{};
+	std::atomic<uint64_t> FallbackBytes{};
+	std::atomic<uint64_t> FallbackCount{};
+};
+
+inline HugePageStats& GetHugePageStats()
+{
+	static HugePageStats lStats{};
+	return lStats;
+}
 
+/**
+ * @brief Support allocator mapping memory backed by 2 MB pages, meant for large arenas and pools.
+ *
+ * Tries reserved huge pages first (MAP_HUGETLB, MEM_LARGE_PAGES on Windows), then a 2 MB aligned mapping advised with
+ * MADV_HUGEPAGE so transparent huge pages can back it, and finally plain 4 KB pages. Which one served each request is
+ * accumulated in GetHugePageStats. Sizes are rounded up to whole huge pages, so use it for few, big blocks only.
+ *
+ * Every block starts on a huge page boundary whatever the backing, which is all Owns checks. As the first tier of a
+ * FallbackAllocator pair it with allocators that don't hand out 2 MB aligned blocks.
+ *
+ */
+class HugePageAllocator
+{
 public:
-	StackAllocator() : mCursor{mData}, mEnd{mData + N}
-	{
-	}
+	static constexpr size_t HUGE_PAGE_SIZE = 2ull * 1024 * 1024;
+	static constexpr size_t MAX_ALIGNMENT  = HUGE_PAGE_SIZE;
 
 public:
-	MemoryBlock Allocate(size_t Size, size_t Alignment = sizeof(std::max_align_t))
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
 	{
-		const auto lAlignedSize = RoundToAligned(Size, Alignment);
-		if (lAlignedSize > (mEnd - mCursor))
+		assert(Alignment <= HUGE_PAGE_SIZE && "Invalid alignment.");
+		UNUSED(Alignment);
+		const size_t   lSize  = RoundToAligned(Size, HUGE_PAGE_SIZE);
+		HugePageStats& lStats = GetHugePageStats();
+#if _WIN32
+		const size_t lLargePage = GetLargePageMinimum();
+		if (lLargePage && HUGE_PAGE_SIZE % lLargePage == 0)
+		{
+			if (void* lPtr = VirtualAlloc(nullptr, lSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE))
+			{
+				lStats.ExplicitBytes.fetch_add(lSize, std::memory_order_relaxed);
+				return MemoryBlock{static_cast<uint8_t*>(lPtr), Size};
+			}
+		}
+		// Reserves one extra huge page to find an aligned address, then maps exactly there. Another thread can take
+		// the range in between, so retry until the mapping lands.
+		void* lPtr = nullptr;
+		while (!lPtr)
+		{
+			void* lReserved = VirtualAlloc(nullptr, lSize + HUGE_PAGE_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+			if (!lReserved)
+				return MemoryBlock{};
+			void* lAligned =
+				reinterpret_cast<void*>(RoundToAligned(reinterpret_cast<size_t>(lReserved), HUGE_PAGE_SIZE));
+			VirtualFree(lReserved, 0, MEM_RELEASE);
+			lPtr = VirtualAlloc(lAligned, lSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		}
+#else
+#ifdef MAP_HUGETLB
+		void* lHuge = mmap(nullptr, lSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (lHuge != MAP_FAILED)
 		{
+			lStats.ExplicitBytes.fetch_add(lSize, std::memory_order_relaxed);
+			return MemoryBlock{static_cast<uint8_t*>(lHuge), Size};
+		}
+#endif
+		// Over-maps by one huge page and trims both ends so the mapping starts on a huge page boundary.
+		void* lMapping =
+			mmap(nullptr, lSize + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (lMapping == MAP_FAILED)
 			return MemoryBlock{};
+		const size_t   lHead = RoundToAligned(reinterpret_cast<size_t>(lMapping), HUGE_PAGE_SIZE) -
+							 reinterpret_cast<size_t>(lMapping);
+		uint8_t* const lPtr	 = static_cast<uint8_t*>(lMapping) + lHead;
+		if (lHead)
+			munmap(lMapping, lHead);
+		if (lHead != HUGE_PAGE_SIZE)
+			munmap(lPtr + lSize, HUGE_PAGE_SIZE - lHead);
+#ifdef MADV_HUGEPAGE
+		if (madvise(lPtr, lSize, MADV_HUGEPAGE) == 0)
+		{
+			lStats.TransparentBytes.fetch_add(lSize, std::memory_order_relaxed);
+			return MemoryBlock{lPtr, Size};
 		}
-		void* lPtr = mCursor;
-		mCursor += lAlignedSize;
-		return MemoryBlock{lPtr, Size};
+#endif
+#endif
+		lStats.FallbackBytes.fetch_add(lSize, std::memory_order_relaxed);
+		lStats.FallbackCount.fetch_add(1, std::memory_order_relaxed);
+		return MemoryBlock{static_cast<uint8_t*>(lPtr), Size};
 	}
 
 	void Deallocate(MemoryBlock& Mb)
 	{
-		if (Mb.Ptr + RoundToAligned(Mb.Size) == mCursor)
+		if (Mb.Ptr)
 		{
-			mCursor = Mb.Ptr;
+#if _WIN32
+			VirtualFree(Mb.Ptr, 0, MEM_RELEASE);
+#else
+			munmap(Mb.Ptr, RoundToAligned(Mb.Size, HUGE_PAGE_SIZE));
+#endif
 		}
 		Mb = {};
 	}
 
-	void DeallocateAll()
-	{
-		mCursor = mData;
-	}
-
 	[[nodiscard]] bool Owns(MemoryBlock Mb) const
 	{
-		return Mb.Ptr >= mData && Mb.Ptr < mEnd;
+		return Mb.Ptr && IsAligned(Mb.Ptr, HUGE_PAGE_SIZE);
 	}
 };
 
-template<typename TSupportAllocator, size_t BlockSize, size_t ToleranceMin, size_t ToleranceMax>
-class FreeListAllocator
+template<size_t N>
+class StackAllocator
 {
-	static_assert(BlockSize >= sizeof(intptr_t), "BlockSize needs to be greater or equal sizeof(intptr_t).");
+	alignas(std::max_align_t) uint8_t mData[N];
+	uint8_t *mCursor{}, *mEnd{};
 
-	struct Node
+public:
+	static constexpr size_t MAX_ALIGNMENT = ALIGNMENT_ANY;
+
+public:
+	BC_CONSTEXPR20 StackAllocator() : mCursor{mData}, mEnd{mData + N}
 	{
-		Node* Next{};
-	};
-	Node*			  mHead{};
-	TSupportAllocator mAllocator{};
+	}
 
 public:
-	MemoryBlock Allocate(size_t Size, size_t Alignment = sizeof(std::max_align_t))
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
 	{
-#ifndef NDEBUG
-		if ((Size >= ToleranceMin && Size <= ToleranceMax) && mHead)
+		assert(IsPowerOfTwo(Alignment) && "Invalid alignment.");
+		// The cursor is aligned up front, the size keeps the default rounding Deallocate relies on.
+		const size_t lOffset = RoundToAligned(reinterpret_cast<size_t>(mCursor), Alignment) -
+							   reinterpret_cast<size_t>(mCursor);
+		const size_t lAlignedSize = RoundToAligned(Size);
+		if (lOffset + lAlignedSize > static_cast<size_t>(mEnd - mCursor))
 		{
-			intptr_t* lPtr = reinterpret_cast<intptr_t*>(mHead);
-			mHead		   = mHead->Next;
-			return MemoryBlock{lPtr + 1ull, Size};
+			return MemoryBlock{};
 		}
-		const MemoryBlock lMemoryBlock = mAllocator.Allocate(BlockSize + sizeof(intptr_t), Alignment);
-		intptr_t*		  lIntPtr	   = static_cast<intptr_t*>(lMemoryBlock.Ptr);
-		*lIntPtr					   = reinterpret_cast<intptr_t>(this);
-		return MemoryBlock{lIntPtr + 1ull, lMemoryBlock.Size};
-#else
-		if ((Size >= ToleranceMin && Size <= ToleranceMax) && mHead)
+		uint8_t* lPtr = mCursor + lOffset;
+		mCursor		  = lPtr + lAlignedSize;
+		return MemoryBlock{lPtr, Size};
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		if (Mb.Ptr + RoundToAligned(Mb.Size) == mCursor)
 		{
-			void* lPtr = mHead;
-			mHead	   = mHead->Next;
-			return MemoryBlock{lPtr, Size};
+			mCursor = Mb.Ptr;
+		}
+		Mb = {};
+	}
+
+	/**
+	 * @brief Typed allocation, also usable in C++20 constant evaluation.
+	 *
+	 * At runtime the array is carved from the stack buffer like Allocate(sizeof(T) * Size, alignof(T)).
+	 *
+	 * During constant evaluation bytes cannot be reinterpreted as T, so the allocator silently switches strategy: the
+	 * elements come from a transient std::allocator<T> and the stack only charges their rounded size against its
+	 * capacity. Those arrays don't live in the stack buffer, so Owns and Region don't cover them, alignment padding
+	 * isn't charged, and DeallocateArray rewinds the cursor by the array size whatever the release order, where the
+	 * runtime path only rewinds for the topmost block. They have to be released through DeallocateArray before the
+	 * evaluation ends, after copying what is needed into a std::array or similar.
+	 *
+	 */
+	template<typename T>
+	BC_CONSTEXPR20 ArrayInstance<T> AllocateArray(size_t Size)
+	{
+#if BC_LANGUAGE_VERSION >= BC_LANGUAGE_CPP20
+		if (BC_IS_CONSTANT_EVALUATED())
+		{
+			const size_t lAlignedSize = RoundToAligned(sizeof(T) * Size);
+			if (lAlignedSize > static_cast<size_t>(mEnd - mCursor))
+				return ArrayInstance<T>{};
+			mCursor += lAlignedSize;
+			return ArrayInstance<T>{std::allocator<T>{}.allocate(Size), Size};
 		}
-		return mAllocator.Allocate(BlockSize, Alignment);
 #endif
+		const MemoryBlock lMemoryBlock = Allocate(sizeof(T) * Size, alignof(T));
+		if (!lMemoryBlock.Ptr)
+			return ArrayInstance<T>{};
+		return ArrayInstance<T>{reinterpret_cast<T*>(lMemoryBlock.Ptr), Size};
 	}
 
-	void Deallocation(MemoryBlock Mb)
+	/**
+	 * @brief Releases an AllocateArray result, see AllocateArray for how constant evaluation differs.
+	 *
+	 */
+	template<typename T>
+	BC_CONSTEXPR20 void DeallocateArray(ArrayInstance<T>& Array)
 	{
-#ifndef NDEBUG
-		if (!OwnsConditionDebug(Mb))
+#if BC_LANGUAGE_VERSION >= BC_LANGUAGE_CPP20
+		if (BC_IS_CONSTANT_EVALUATED())
+		{
+			if (Array.Value)
+				std::allocator<T>{}.deallocate(Array.Value, Array.Size);
+			if (mCursor - mData >= static_cast<ptrdiff_t>(RoundToAligned(sizeof(T) * Array.Size)))
+				mCursor -= RoundToAligned(sizeof(T) * Array.Size);
+			Array = {};
 			return;
+		}
 #endif
-		if (Mb.Size != BlockSize)
-			mAllocator.Deallocate(Mb);
-		Node* lNewNode = static_cast<Node*>(Mb.Ptr);
-		lNewNode->Next = mHead;
-		mHead		   = lNewNode;
+		MemoryBlock lMemoryBlock{reinterpret_cast<uint8_t*>(Array.Value), sizeof(T) * Array.Size};
+		Deallocate(lMemoryBlock);
+		Array = {};
+	}
+
+	BC_CONSTEXPR20 void DeallocateAll()
+	{
+		mCursor = mData;
+	}
+
+	[[nodiscard]] BC_CONSTEXPR20 size_t Used() const
+	{
+		return static_cast<size_t>(mCursor - mData);
 	}
 
 	[[nodiscard]] bool Owns(MemoryBlock Mb) const
 	{
-#ifndef NDEBUG
-		return OwnsConditionDebug(Mb) || mAllocator.Owns(Mb);
-#else
-		return Mb.Size == BlockSize || mAllocator.Owns(Mb);
-#endif
+		return Mb.Ptr >= mData && Mb.Ptr < mEnd;
 	}
 
-#ifndef NDEBUG
-	[[nodiscard]] bool OwnsConditionDebug(MemoryBlock Mb) const
+	[[nodiscard]] MemoryBlock Region() const
 	{
-		return *(reinterpret_cast<intptr_t*>(Mb.Ptr) - 1ull) == reinterpret_cast<intptr_t>(this);
+		return MemoryBlock{const_cast<uint8_t*>(mData), N};
 	}
-#endif
 };
 
-template<size_t ElementSize, typename TSupportAllocator>
-class PoolAllocator
+/**
+ * @brief Circular buffer of variable size blocks released a frame at a time once a fence passes.
+ *
+ * Blocks are carved from the head of a Capacity bytes region taken from TSupportAllocator; a block that does not fit
+ * before the end wraps around to the start. EndFrame tags everything allocated since the previous call with a fence
+ * value, and Reclaim, given the last fence the consumer completed, moves the tail past every frame up to it. This fits
+ * staging data for a consumer lagging a few frames behind. Deallocate does nothing, blocks only go back through fences.
+ *
+ */
+template<size_t Capacity, typename TSupportAllocator, size_t MaxFrames = 8>
+class RingAllocator
 {
-	static_assert(ElementSize >= sizeof(intptr_t), "ElementSize needs to be greater or equal sizeof(intptr_t).");
-	struct FreeList
+	static_assert(Capacity > 0 && MaxFrames > 0, "Invalid RingAllocator configuration.");
+
+	struct Frame
 	{
-		FreeList* Next{};
+		uint64_t Fence;
+		uint64_t End;
 	};
 
-	MemoryBlock		  mData{};
-	uint64_t		  mCursor{};
-	FreeList*		  mFreeList{};
 	TSupportAllocator mAllocator{};
+	MemoryBlock		  mData{};
+	// Monotonic byte positions, the live range [mTail, mHead) never spans more than Capacity bytes.
+	uint64_t mHead{};
+	uint64_t mTail{};
+	Frame	 mFrames[MaxFrames]{};
+	size_t	 mFrameFirst{};
+	size_t	 mFrameCount{};
 
 public:
-	static constexpr size_t ALIGNMENT = RoundToAligned(ElementSize);
+	static constexpr size_t MAX_ALIGNMENT = ALIGNMENT_ANY;
 
 public:
-	PoolAllocator(const uint64_t Capacity) : mData{mAllocator.Allocate(ElementSize * Capacity, ALIGNMENT)}
+	RingAllocator() : mData{mAllocator.Allocate(Capacity)}
 	{
 	}
 
-	~PoolAllocator()
+	~RingAllocator()
 	{
 		mAllocator.Deallocate(mData);
 	}
 
+	RingAllocator(const RingAllocator&)			   = delete;
+	RingAllocator& operator=(const RingAllocator&) = delete;
+
 public:
-	MemoryBlock Allocate(size_t, size_t)
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
 	{
-		void* lPtr;
-		if (mFreeList)
+		assert(IsPowerOfTwo(Alignment) && "Invalid alignment.");
+		if (!mData.Ptr || !Size)
+			return MemoryBlock{};
+		uint64_t lHead	 = mHead;
+		size_t	 lOffset = AlignedOffset(static_cast<size_t>(lHead % Capacity), Alignment);
+		if (lOffset + Size > Capacity)
 		{
-			lPtr	  = mFreeList;
-			mFreeList = mFreeList->Next;
+			lHead += Capacity - lHead % Capacity;
+			lOffset = AlignedOffset(0, Alignment);
+			if (lOffset + Size > Capacity)
+				return MemoryBlock{};
 		}
-		else
+		const uint64_t lEnd = lHead - lHead % Capacity + lOffset + Size;
+		if (lEnd - mTail > Capacity)
+			return MemoryBlock{};
+		mHead = lEnd;
+		return MemoryBlock{mData.Ptr + lOffset, Size};
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		Mb = {};
+	}
+
+	/**
+	 * @brief Closes the current frame, its blocks are reclaimed once Reclaim sees Fence completed.
+	 *
+	 * Fences have to be non decreasing. Returns false when MaxFrames frames are already pending, the open frame then
+	 * keeps growing until a later EndFrame succeeds.
+	 *
+	 */
+	bool EndFrame(const uint64_t Fence)
+	{
+		if (mFrameCount == MaxFrames)
+			return false;
+		assert((!mFrameCount || Fence >= mFrames[(mFrameFirst + mFrameCount - 1) % MaxFrames].Fence) &&
+			   "Fences have to be non decreasing.");
+		mFrames[(mFrameFirst + mFrameCount) % MaxFrames] = Frame{Fence, mHead};
+		++mFrameCount;
+		return true;
+	}
+
+	/**
+	 * @brief Releases every frame whose fence is less or equal to CompletedFence. Returns the bytes released.
+	 *
+	 */
+	size_t Reclaim(const uint64_t CompletedFence)
+	{
+		const uint64_t lTail = mTail;
+		while (mFrameCount && mFrames[mFrameFirst].Fence <= CompletedFence)
 		{
-			if ((mCursor + ElementSize) < mData.Size)
-				return MemoryBlock{};
-			lPtr = mData.Ptr + mCursor;
-			mCursor += ElementSize;
+			mTail		= mFrames[mFrameFirst].End;
+			mFrameFirst = (mFrameFirst + 1) % MaxFrames;
+			--mFrameCount;
 		}
-		return MemoryBlock{lPtr, ElementSize};
+		return static_cast<size_t>(mTail - lTail);
 	}
 
-	void Deallocate(MemoryBlock Mb)
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
 	{
-		FreeList* lNewNode = reinterpret_cast<FreeList*>(Mb.Ptr);
-		lNewNode->Next	   = mFreeList;
-		mFreeList		   = lNewNode;
+		return Mb.Ptr >= mData.Ptr && Mb.Ptr < mData.Ptr + mData.Size;
+	}
+
+	[[nodiscard]] MemoryBlock Region() const
+	{
+		return mData;
+	}
+
+	// Bytes between the oldest unreclaimed block and the head, wrap padding included.
+	[[nodiscard]] size_t Used() const
+	{
+		return static_cast<size_t>(mHead - mTail);
+	}
+
+	[[nodiscard]] size_t PendingFrames() const
+	{
+		return mFrameCount;
+	}
+
+private:
+	BC_INLINE size_t AlignedOffset(const size_t Offset, const size_t Alignment) const
+	{
+		const uintptr_t lBase = reinterpret_cast<uintptr_t>(mData.Ptr);
+		return static_cast<size_t>(RoundToAligned(lBase + Offset, Alignment) - lBase);
+	}
+};
+
+/**
+ * @brief Recycles BlockSize blocks for requests sized within [ToleranceMin, ToleranceMax].
+ *
+ * Other sizes go straight to TSupportAllocator. A recycled block is only handed out when it satisfies the requested
+ * alignment, otherwise a fresh one is allocated. Debug builds tag blocks with their owner right after the BlockSize
+ * usable bytes, so the block start and its alignment stay untouched.
+ *
+ */
+template<typename TSupportAllocator, size_t BlockSize, size_t ToleranceMin, size_t ToleranceMax>
+class FreeListAllocator
+{
+	struct Node
+	{
+		Node* Next{};
+	};
+	static_assert(BlockSize >= sizeof(Node), "BlockSize needs to be greater or equal sizeof(Node).");
+	static_assert(ToleranceMin <= ToleranceMax && ToleranceMax <= BlockSize, "Tolerance needs to fit in BlockSize.");
+
+#ifndef NDEBUG
+	static constexpr size_t TAG_SIZE = sizeof(intptr_t);
+#else
+	static constexpr size_t TAG_SIZE = 0;
+#endif
+
+	Node*				mHead{};
+	std::atomic<size_t> mLength{};
+	TSupportAllocator	mAllocator{};
+
+	// Scavenging state, allocated on the first Scavenge: idle timestamps of the list positions counted from the bottom.
+	// Blocks are only pushed and popped at the top, so the positions below mLowWater, the shortest the list got since
+	// the previous Scavenge, kept their block.
+	MemoryBlock mIdleData{};
+	size_t		mLowWater{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = AllocatorMaxAlignment<TSupportAllocator>::value;
+
+public:
+	FreeListAllocator() = default;
+	~FreeListAllocator()
+	{
+		if (mIdleData.Ptr)
+			mAllocator.Deallocate(mIdleData);
+		while (mHead)
+		{
+			Node*		lNext = mHead->Next;
+			MemoryBlock lMb	  = BlockOf(mHead);
+			mAllocator.Deallocate(lMb);
+			mHead = lNext;
+		}
+	}
+
+	FreeListAllocator(const FreeListAllocator&)			   = delete;
+	FreeListAllocator& operator=(const FreeListAllocator&) = delete;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		if (!((Size >= ToleranceMin && Size <= ToleranceMax) || Size == BlockSize))
+			return mAllocator.Allocate(Size, Alignment);
+		if (mHead && IsAligned(mHead, Alignment))
+		{
+			uint8_t* lPtr = reinterpret_cast<uint8_t*>(mHead);
+			mHead		  = mHead->Next;
+			const size_t lLength = SingleWriterSub<size_t>(mLength, 1);
+			if (lLength < mLowWater)
+				mLowWater = lLength;
+			return MemoryBlock{lPtr, BlockSize};
+		}
+		const MemoryBlock lMemoryBlock = mAllocator.Allocate(BlockSize + TAG_SIZE, Alignment);
+		if (!lMemoryBlock.Ptr)
+			return MemoryBlock{};
+#ifndef NDEBUG
+		const intptr_t lTag = reinterpret_cast<intptr_t>(this);
+		BC_MEMCPY(lMemoryBlock.Ptr + BlockSize, &lTag, sizeof(lTag));
+#endif
+		return MemoryBlock{lMemoryBlock.Ptr, BlockSize};
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		if (Mb.Size != BlockSize)
+		{
+			mAllocator.Deallocate(Mb);
+			return;
+		}
+#ifndef NDEBUG
+		assert(OwnsConditionDebug(Mb) && "Block wasn't allocated by this allocator.");
+#endif
+		Node* lNewNode = reinterpret_cast<Node*>(Mb.Ptr);
+		lNewNode->Next = mHead;
+		mHead		   = lNewNode;
+		Mb			   = {};
+		SingleWriterAdd<size_t>(mLength, 1);
+	}
+
+	/**
+	 * @brief Returns blocks that stayed on the free list for at least Decay to the support allocator.
+	 *
+	 * A block starts aging at the first Scavenge finding it free and is released by the first one past its decay, so
+	 * call it periodically, e.g. once per frame or server tick. Ages live in a side array taken from the support
+	 * allocator, one timestamp per free block, so blocks keep their BlockSize bytes and Deallocate is untouched.
+	 * Returns the bytes released.
+	 *
+	 */
+	size_t Scavenge(const std::chrono::milliseconds Decay,
+					const std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now())
+	{
+		const uint64_t lNow	   = ScavengeTimestamp(Now);
+		const size_t   lLength = FreeListLength();
+		if (!ReserveIdleData(lLength))
+			return 0;
+		uint64_t* lIdleSince = reinterpret_cast<uint64_t*>(mIdleData.Ptr);
+		for (size_t lPosition = std::min(mLowWater, lLength); lPosition < lLength; ++lPosition)
+			lIdleSince[lPosition] = lNow;
+
+		// Timestamps never decrease towards the top, so the expired blocks are the bottom ones.
+		size_t lExpired = 0;
+		while (lExpired < lLength && lNow >= lIdleSince[lExpired] + static_cast<uint64_t>(Decay.count()))
+			++lExpired;
+		size_t lReleased = 0;
+		if (lExpired)
+		{
+			Node** lLink = &mHead;
+			for (size_t lPosition = lExpired; lPosition < lLength; ++lPosition)
+				lLink = &(*lLink)->Next;
+			for (Node* lNode = *lLink; lNode;)
+			{
+				Node*		lNext = lNode->Next;
+				MemoryBlock lMb	  = BlockOf(lNode);
+				lReleased += lMb.Size;
+				mAllocator.Deallocate(lMb);
+				lNode = lNext;
+			}
+			*lLink = nullptr;
+			BC_MEMMOVE(lIdleSince, lIdleSince + lExpired, (lLength - lExpired) * sizeof(uint64_t));
+			SingleWriterSub<size_t>(mLength, lExpired);
+		}
+		mLowWater = lLength - lExpired;
+		return lReleased;
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+#ifndef NDEBUG
+		if (Mb.Size == BlockSize)
+			return OwnsConditionDebug(Mb);
+#endif
+		return Mb.Size == BlockSize || mAllocator.Owns(Mb);
+	}
+
+	// Safe to read from any thread, e.g. a telemetry one.
+	[[nodiscard]] size_t FreeListLength() const
+	{
+		return mLength.load(std::memory_order_relaxed);
+	}
+
+#ifndef NDEBUG
+	[[nodiscard]] bool OwnsConditionDebug(MemoryBlock Mb) const
+	{
+		intptr_t lTag;
+		BC_MEMCPY(&lTag, Mb.Ptr + BlockSize, sizeof(lTag));
+		return lTag == reinterpret_cast<intptr_t>(this);
+	}
+#endif
+
+private:
+	BC_INLINE static MemoryBlock BlockOf(Node* Value)
+	{
+		return MemoryBlock{reinterpret_cast<uint8_t*>(Value), BlockSize + TAG_SIZE};
+	}
+
+	// Grows the idle timestamps to Count entries, keeping the ones below mLowWater.
+	bool ReserveIdleData(const size_t Count)
+	{
+		if (mIdleData.Size >= Count * sizeof(uint64_t))
+			return true;
+		const size_t	  lCapacity = std::max(Count, mIdleData.Size / sizeof(uint64_t) * 2);
+		const MemoryBlock lData		= mAllocator.Allocate(lCapacity * sizeof(uint64_t), alignof(uint64_t));
+		if (!lData.Ptr)
+			return false;
+		if (mIdleData.Ptr)
+		{
+			const size_t lKept = std::min(mLowWater, mIdleData.Size / sizeof(uint64_t));
+			BC_MEMCPY(lData.Ptr, mIdleData.Ptr, lKept * sizeof(uint64_t));
+			mAllocator.Deallocate(mIdleData);
+		}
+		mIdleData = lData;
+		return true;
+	}
+};
+
+/**
+ * @brief Fixed size element pool over a single region.
+ *
+ * Elements are ElementAlignment aligned, by default alignof(std::max_align_t) like malloc so requests with the default
+ * alignment are served, requests asking for more are rejected. Small elements pack tighter with a smaller
+ * ElementAlignment, requested explicitly, e.g. PoolAllocator<8, Mallocator, 8> and Allocate(8, 8). Scavenge returns
+ * the pages whose elements all stayed free for a decay time to the OS. Elements on released pages are parked off the
+ * free list and only brought back when it runs dry, so Allocate and Deallocate keep their cost.
+ *
+ */
+template<size_t ElementSize, typename TSupportAllocator, size_t ElementAlignment = alignof(std::max_align_t)>
+class PoolAllocator
+{
+	static_assert(ElementSize >= sizeof(intptr_t), "ElementSize needs to be greater or equal sizeof(intptr_t).");
+	static_assert(IsPowerOfTwo(ElementAlignment), "ElementAlignment needs to be a power of two.");
+	struct FreeList
+	{
+		FreeList* Next{};
+	};
+
+	static constexpr uint64_t PAGE_RELEASED	 = ~0ull;
+	static constexpr uint64_t PAGE_RELEASING = ~0ull - 1;
+
+	TSupportAllocator mAllocator{};
+	MemoryBlock		  mData{};
+	uint64_t		  mCursor{};
+	FreeList*			mFreeList{};
+	std::atomic<size_t> mOccupied{};
+
+	// Scavenging state, allocated on the first Scavenge: per page idle timestamps then parked and free element bits.
+	MemoryBlock mScavengeData{};
+	uint64_t*	mPageIdleSince{};
+	uint64_t*	mParkedBits{};
+	uint64_t*	mFreeBits{};
+	uint8_t*	mPageBase{};
+	size_t		mPageCount{};
+	size_t		mParkedCount{};
+
+public:
+	// Elements are laid out every STRIDE bytes from an ElementAlignment aligned region, so each one keeps it.
+	static constexpr size_t STRIDE		  = RoundToAligned(ElementSize, ElementAlignment);
+	static constexpr size_t ALIGNMENT	  = ElementAlignment;
+	static constexpr size_t MAX_ALIGNMENT = ElementAlignment;
+
+public:
+	PoolAllocator(const uint64_t Capacity) : mData{mAllocator.Allocate(STRIDE * Capacity, ALIGNMENT)}
+	{
+	}
+
+	~PoolAllocator()
+	{
+		if (mScavengeData.Ptr)
+			mAllocator.Deallocate(mScavengeData);
+		mAllocator.Deallocate(mData);
+	}
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		if (Size > STRIDE || Alignment > ElementAlignment)
+			return MemoryBlock{};
+		uint8_t* lPtr;
+		if (mFreeList || (mParkedCount && Unpark()))
+		{
+			lPtr	  = reinterpret_cast<uint8_t*>(mFreeList);
+			mFreeList = mFreeList->Next;
+		}
+		else
+		{
+			if ((mCursor + STRIDE) > mData.Size)
+				return MemoryBlock{};
+			lPtr = mData.Ptr + mCursor;
+			mCursor += STRIDE;
+		}
+		SingleWriterAdd<size_t>(mOccupied, 1);
+		return MemoryBlock{lPtr, STRIDE};
+	}
+
+	void Deallocate(MemoryBlock Mb)
+	{
+		Push(Mb.Ptr);
+		SingleWriterSub<size_t>(mOccupied, 1);
+	}
+
+	/**
+	 * @brief Releases to the OS the pages whose elements were all free at every Scavenge spanning at least Decay.
+	 *
+	 * Call it periodically, e.g. once per frame or server tick. Returns the bytes released.
+	 *
+	 */
+	size_t Scavenge(const std::chrono::milliseconds Decay,
+					const std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now())
+	{
+		if (!mData.Ptr || (!mScavengeData.Ptr && !InitScavenge()))
+			return 0;
+		BC_MEMZERO(mFreeBits, BitWordCount() * sizeof(uint64_t));
+		for (FreeList* lNode = mFreeList; lNode; lNode = lNode->Next)
+			SetBit(mFreeBits, IndexOf(lNode));
+
+		const uint64_t lNow		 = ScavengeTimestamp(Now);
+		const size_t   lPageSize = VirtualPageSize();
+		const size_t   lTouched	 = mCursor / STRIDE;
+		bool		   lParked	 = false;
+		bool		   lRelease	 = false;
+		for (size_t lPage = 0; lPage < mPageCount; ++lPage)
+		{
+			const size_t lBegin = static_cast<size_t>(mPageBase - mData.Ptr) + lPage * lPageSize;
+			if (lBegin >= mCursor)
+				break;
+			if (mPageIdleSince[lPage] == PAGE_RELEASED)
+				continue;
+			const size_t lFirst = lBegin / STRIDE;
+			const size_t lLast	= (lBegin + lPageSize - 1) / STRIDE;
+			bool		 lIdle	= true;
+			for (size_t lIndex = lFirst; lIdle && lIndex <= lLast && lIndex < lTouched; ++lIndex)
+				lIdle = TestBit(mFreeBits, lIndex) || TestBit(mParkedBits, lIndex);
+			if (!lIdle || !mPageIdleSince[lPage])
+			{
+				mPageIdleSince[lPage] = lIdle ? lNow : 0;
+				continue;
+			}
+			if (lNow < mPageIdleSince[lPage] + static_cast<uint64_t>(Decay.count()))
+				continue;
+			for (size_t lIndex = lFirst; lIndex <= lLast && lIndex < lTouched; ++lIndex)
+			{
+				if (TestBit(mParkedBits, lIndex))
+					continue;
+				SetBit(mParkedBits, lIndex);
+				++mParkedCount;
+				lParked = true;
+			}
+			mPageIdleSince[lPage] = PAGE_RELEASING;
+			lRelease			  = true;
+		}
+		if (!lRelease)
+			return 0;
+
+		// Pages are only decommitted once none of their free list nodes is still linked.
+		for (FreeList** lLink = &mFreeList; lParked && *lLink;)
+		{
+			if (TestBit(mParkedBits, IndexOf(*lLink)))
+				*lLink = (*lLink)->Next;
+			else
+				lLink = &(*lLink)->Next;
+		}
+		size_t lReleased = 0;
+		for (size_t lPage = 0; lPage < mPageCount; ++lPage)
+		{
+			if (mPageIdleSince[lPage] != PAGE_RELEASING)
+				continue;
+			mPageIdleSince[lPage] = PAGE_RELEASED;
+			lReleased += VirtualDecommit(mPageBase + lPage * lPageSize, lPageSize);
+		}
+		return lReleased;
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return Mb.Ptr >= mData.Ptr && Mb.Ptr < mData.Ptr + mData.Size;
+	}
+
+	[[nodiscard]] MemoryBlock Region() const
+	{
+		return mData;
+	}
+
+	// Safe to read from any thread, e.g. a telemetry one.
+	[[nodiscard]] size_t Occupied() const
+	{
+		return mOccupied.load(std::memory_order_relaxed);
+	}
+
+	// Element count of the region.
+	[[nodiscard]] size_t Capacity() const
+	{
+		return mData.Size / STRIDE;
+	}
+
+private:
+	BC_INLINE void Push(uint8_t* Ptr)
+	{
+		FreeList* lNewNode = reinterpret_cast<FreeList*>(Ptr);
+		lNewNode->Next	   = mFreeList;
+		mFreeList		   = lNewNode;
+	}
+
+	BC_INLINE size_t IndexOf(const void* Ptr) const
+	{
+		return static_cast<size_t>(static_cast<const uint8_t*>(Ptr) - mData.Ptr) / STRIDE;
+	}
+	BC_INLINE size_t BitWordCount() const
+	{
+		return (mData.Size / STRIDE + 63) / 64;
+	}
+	static BC_INLINE bool TestBit(const uint64_t* Bits, const size_t Index)
+	{
+		return (Bits[Index / 64] >> (Index % 64)) & 1;
+	}
+	static BC_INLINE void SetBit(uint64_t* Bits, const size_t Index)
+	{
+		Bits[Index / 64] |= 1ull << (Index % 64);
+	}
+	static BC_INLINE void ClearBit(uint64_t* Bits, const size_t Index)
+	{
+		Bits[Index / 64] &= ~(1ull << (Index % 64));
+	}
+
+	bool InitScavenge()
+	{
+		const uintptr_t lPageMask = VirtualPageSize() - 1;
+		const uintptr_t lBegin	  = (reinterpret_cast<uintptr_t>(mData.Ptr) + lPageMask) & ~lPageMask;
+		const uintptr_t lEnd	  = (reinterpret_cast<uintptr_t>(mData.Ptr) + mData.Size) & ~lPageMask;
+		mPageBase				  = reinterpret_cast<uint8_t*>(lBegin);
+		mPageCount				  = lEnd > lBegin ? (lEnd - lBegin) / (lPageMask + 1) : 0;
+		mScavengeData = mAllocator.Allocate((mPageCount + 2 * BitWordCount()) * sizeof(uint64_t), alignof(uint64_t));
+		if (!mScavengeData.Ptr)
+			return false;
+		BC_MEMZERO(mScavengeData.Ptr, mScavengeData.Size);
+		mPageIdleSince = reinterpret_cast<uint64_t*>(mScavengeData.Ptr);
+		mParkedBits	   = mPageIdleSince + mPageCount;
+		mFreeBits	   = mParkedBits + BitWordCount();
+		return true;
+	}
+
+	// Relinks the parked elements of the first released page, which faults it back in.
+	BC_NOINLINE bool Unpark()
+	{
+		const size_t lPageSize = VirtualPageSize();
+		const size_t lTouched  = mCursor / STRIDE;
+		for (size_t lPage = 0; lPage < mPageCount; ++lPage)
+		{
+			if (mPageIdleSince[lPage] != PAGE_RELEASED)
+				continue;
+			const size_t lBegin = static_cast<size_t>(mPageBase - mData.Ptr) + lPage * lPageSize;
+			const size_t lLast	= (lBegin + lPageSize - 1) / STRIDE;
+			for (size_t lIndex = lBegin / STRIDE; lIndex <= lLast && lIndex < lTouched; ++lIndex)
+			{
+				if (!TestBit(mParkedBits, lIndex))
+					continue;
+				ClearBit(mParkedBits, lIndex);
+				--mParkedCount;
+				Push(mData.Ptr + lIndex * STRIDE);
+			}
+			mPageIdleSince[lPage] = 0;
+			if (mFreeList)
+				return true;
+		}
+		return mFreeList != nullptr;
+	}
+};
+
+/**
+ * @brief Two-Level Segregated Fit allocator.
+ *
+ * Serves variable-size blocks out of a single Capacity bytes region taken from TSupportAllocator. Free blocks are kept
+ * in segregated lists indexed by a first level (power of two) and a second level (linear subdivision) bitmap, so both
+ * Allocate and Deallocate run in O(1) worst case. Released blocks are coalesced with their physical neighbours
+ * immediately, which keeps fragmentation bounded without any deferred work.
+ *
+ */
+template<size_t Capacity, typename TSupportAllocator>
+class TlsfAllocator
+{
+	static constexpr size_t SL_INDEX_COUNT_LOG2 = 5;
+	static constexpr size_t SL_INDEX_COUNT		= 1ull << SL_INDEX_COUNT_LOG2;
+	static constexpr size_t ALIGN_SIZE_LOG2		= 4;
+	static constexpr size_t ALIGN_SIZE			= 1ull << ALIGN_SIZE_LOG2;
+	static constexpr size_t FL_INDEX_SHIFT		= SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+	static constexpr size_t SMALL_BLOCK_SIZE	= 1ull << FL_INDEX_SHIFT;
+
+	static constexpr size_t Log2(size_t Value)
+	{
+		size_t lResult = 0;
+		while (Value >>= 1)
+			++lResult;
+		return lResult;
+	}
+
+	static constexpr size_t FL_INDEX_COUNT = Log2(Capacity) - FL_INDEX_SHIFT + 2;
+
+	static_assert(Capacity >= SMALL_BLOCK_SIZE * 2, "Capacity is too small for a TLSF heap.");
+	static_assert(FL_INDEX_COUNT <= 64, "Capacity exceeds the first level bitmap range.");
+
+	struct Block
+	{
+		Block* PrevPhysical;
+		size_t SizeAndFlags;
+		alignas(ALIGN_SIZE) Block* NextFree;
+		Block* PrevFree;
+
+		BC_INLINE size_t Size() const
+		{
+			return SizeAndFlags & ~size_t{1};
+		}
+		BC_INLINE void SetSize(size_t Size)
+		{
+			SizeAndFlags = Size | (SizeAndFlags & 1);
+		}
+		BC_INLINE bool IsFree() const
+		{
+			return SizeAndFlags & 1;
+		}
+		BC_INLINE void SetFree(bool Free)
+		{
+			SizeAndFlags = Size() | static_cast<size_t>(Free);
+		}
+	};
+
+	static constexpr size_t HEADER_SIZE	   = offsetof(Block, NextFree);
+	static constexpr size_t MIN_BLOCK_SIZE = sizeof(Block) - HEADER_SIZE;
+	static constexpr size_t MIN_GAP_SIZE   = HEADER_SIZE + MIN_BLOCK_SIZE;
+
+	TSupportAllocator mAllocator{};
+	MemoryBlock		  mData{};
+	uint64_t		  mFlBitmap{};
+	uint32_t		  mSlBitmap[FL_INDEX_COUNT]{};
+	Block*			  mBlocks[FL_INDEX_COUNT][SL_INDEX_COUNT]{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = ALIGNMENT_ANY;
+
+public:
+	TlsfAllocator() : mData{mAllocator.Allocate(Capacity, ALIGN_SIZE)}
+	{
+		DeallocateAll();
+	}
+
+	~TlsfAllocator()
+	{
+		mAllocator.Deallocate(mData);
+	}
+
+	TlsfAllocator(const TlsfAllocator&)			   = delete;
+	TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		if (Size == 0 || Size > Capacity)
+			return MemoryBlock{};
+
+		size_t lAdjustedSize = RoundToAligned(Size, ALIGN_SIZE);
+		if (lAdjustedSize < MIN_BLOCK_SIZE)
+			lAdjustedSize = MIN_BLOCK_SIZE;
+
+		// Over-aligned requests reserve room to split a free block off the front.
+		const size_t lGapReserve = Alignment > ALIGN_SIZE ? Alignment + MIN_GAP_SIZE : 0;
+		Block*		 lBlock		 = FindSuitable(lAdjustedSize + lGapReserve);
+		if (!lBlock)
+			return MemoryBlock{};
+		RemoveFree(lBlock);
+
+		if (lGapReserve)
+		{
+			uint8_t* lPayload = Payload(lBlock);
+			uint8_t* lAligned = AlignUp(lPayload, Alignment);
+			if (lAligned != lPayload && static_cast<size_t>(lAligned - lPayload) < MIN_GAP_SIZE)
+				lAligned = AlignUp(lPayload + MIN_GAP_SIZE, Alignment);
+			const size_t lGap = lAligned - lPayload;
+			if (lGap)
+			{
+				Block* lAlignedBlock			  = FromPayload(lAligned);
+				lAlignedBlock->SizeAndFlags		  = lBlock->Size() - lGap;
+				lAlignedBlock->PrevPhysical		  = lBlock;
+				Next(lAlignedBlock)->PrevPhysical = lAlignedBlock;
+				lBlock->SetSize(lGap - HEADER_SIZE);
+				InsertFree(lBlock);
+				lBlock = lAlignedBlock;
+			}
+		}
+
+		if (lBlock->Size() >= lAdjustedSize + MIN_GAP_SIZE)
+		{
+			Block* lRemaining		 = reinterpret_cast<Block*>(Payload(lBlock) + lAdjustedSize);
+			lRemaining->SizeAndFlags	   = lBlock->Size() - lAdjustedSize - HEADER_SIZE;
+			lRemaining->PrevPhysical	   = lBlock;
+			Next(lRemaining)->PrevPhysical = lRemaining;
+			lBlock->SetSize(lAdjustedSize);
+			InsertFree(lRemaining);
+		}
+		lBlock->SetFree(false);
+		return MemoryBlock{Payload(lBlock), Size};
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		if (!Mb.Ptr)
+			return;
+		Block* lBlock = FromPayload(Mb.Ptr);
+		assert(!lBlock->IsFree() && "Double free.");
+
+		Block* lPrev = lBlock->PrevPhysical;
+		if (lPrev && lPrev->IsFree())
+		{
+			RemoveFree(lPrev);
+			lPrev->SetSize(lPrev->Size() + HEADER_SIZE + lBlock->Size());
+			Next(lPrev)->PrevPhysical = lPrev;
+			lBlock					  = lPrev;
+		}
+		Block* lNext = Next(lBlock);
+		if (lNext->IsFree())
+		{
+			RemoveFree(lNext);
+			lBlock->SetSize(lBlock->Size() + HEADER_SIZE + lNext->Size());
+			Next(lBlock)->PrevPhysical = lBlock;
+		}
+		InsertFree(lBlock);
+		Mb = {};
+	}
+
+	void DeallocateAll()
+	{
+		mFlBitmap = 0;
+		BC_MEMZERO(mSlBitmap, sizeof(mSlBitmap));
+		BC_MEMZERO(mBlocks, sizeof(mBlocks));
+		if (!mData.Ptr)
+			return;
+
+		// One free block spanning the region, terminated by a zero sized used sentinel.
+		Block* lFirst			= reinterpret_cast<Block*>(mData.Ptr);
+		lFirst->PrevPhysical	= nullptr;
+		lFirst->SizeAndFlags	= (Capacity & ~(ALIGN_SIZE - 1)) - 2 * HEADER_SIZE;
+		Block* lSentinel		= Next(lFirst);
+		lSentinel->PrevPhysical = lFirst;
+		lSentinel->SizeAndFlags = 0;
+		InsertFree(lFirst);
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return Mb.Ptr >= mData.Ptr && Mb.Ptr < mData.Ptr + mData.Size;
+	}
+
+	[[nodiscard]] MemoryBlock Region() const
+	{
+		return mData;
+	}
+
+private:
+	static BC_INLINE uint8_t* Payload(Block* Value)
+	{
+		return reinterpret_cast<uint8_t*>(Value) + HEADER_SIZE;
+	}
+
+	static BC_INLINE Block* FromPayload(uint8_t* Ptr)
+	{
+		return reinterpret_cast<Block*>(Ptr - HEADER_SIZE);
+	}
+
+	static BC_INLINE Block* Next(Block* Value)
+	{
+		return reinterpret_cast<Block*>(Payload(Value) + Value->Size());
+	}
+
+	static BC_INLINE uint8_t* AlignUp(uint8_t* Ptr, size_t Alignment)
+	{
+		return reinterpret_cast<uint8_t*>(RoundToAligned(reinterpret_cast<uintptr_t>(Ptr), Alignment));
+	}
+
+	static BC_INLINE void Mapping(size_t Size, size_t& Fl, size_t& Sl)
+	{
+		if (Size < SMALL_BLOCK_SIZE)
+		{
+			Fl = 0;
+			Sl = Size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+		}
+		else
+		{
+			Fl = FindLastSet(Size);
+			Sl = (Size >> (Fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+			Fl -= FL_INDEX_SHIFT - 1;
+		}
+	}
+
+	Block* FindSuitable(size_t Size)
+	{
+		// Round up to the next list so any block found there is large enough.
+		if (Size >= SMALL_BLOCK_SIZE)
+			Size += (size_t{1} << (FindLastSet(Size) - SL_INDEX_COUNT_LOG2)) - 1;
+
+		size_t lFl, lSl;
+		Mapping(Size, lFl, lSl);
+		if (lFl >= FL_INDEX_COUNT)
+			return nullptr;
+
+		uint32_t lSlMap = mSlBitmap[lFl] & (~uint32_t{0} << lSl);
+		if (!lSlMap)
+		{
+			const uint64_t lFlMap = mFlBitmap & (~uint64_t{0} << (lFl + 1));
+			if (!lFlMap)
+				return nullptr;
+			lFl	   = FindFirstSet(lFlMap);
+			lSlMap = mSlBitmap[lFl];
+		}
+		return mBlocks[lFl][FindFirstSet(lSlMap)];
+	}
+
+	void InsertFree(Block* Value)
+	{
+		size_t lFl, lSl;
+		Mapping(Value->Size(), lFl, lSl);
+		Value->SetFree(true);
+		Value->PrevFree = nullptr;
+		Value->NextFree = mBlocks[lFl][lSl];
+		if (Value->NextFree)
+			Value->NextFree->PrevFree = Value;
+		mBlocks[lFl][lSl] = Value;
+		mFlBitmap |= uint64_t{1} << lFl;
+		mSlBitmap[lFl] |= uint32_t{1} << lSl;
+	}
+
+	void RemoveFree(Block* Value)
+	{
+		size_t lFl, lSl;
+		Mapping(Value->Size(), lFl, lSl);
+		if (Value->PrevFree)
+			Value->PrevFree->NextFree = Value->NextFree;
+		if (Value->NextFree)
+			Value->NextFree->PrevFree = Value->PrevFree;
+		if (mBlocks[lFl][lSl] == Value)
+		{
+			mBlocks[lFl][lSl] = Value->NextFree;
+			if (!Value->NextFree)
+			{
+				mSlBitmap[lFl] &= ~(uint32_t{1} << lSl);
+				if (!mSlBitmap[lFl])
+					mFlBitmap &= ~(uint64_t{1} << lFl);
+			}
+		}
+		Value->SetFree(false);
+	}
+};
+
+/**
+ * @brief Owner-affine fixed-size heap with a cross-thread remote-free list.
+ *
+ * Each heap belongs to the thread that allocates from it. Blocks carry the address of their owning heap in a prefix,
+ * so a block released through another thread's heap is pushed onto the owner's lock-free remote-free list instead of
+ * its local one. The owner takes the whole remote list back in one exchange when its local list runs dry, so the same
+ * thread Allocate/Deallocate path never touches an atomic. The owner must outlive every block it handed out.
+ *
+ */
+template<size_t BlockSize, typename TSupportAllocator, size_t PageCapacity = 256>
+class OwnerHeapAllocator
+{
+	static_assert(BlockSize >= sizeof(intptr_t), "BlockSize needs to be greater or equal sizeof(intptr_t).");
+	static_assert(PageCapacity > 0, "PageCapacity needs to be greater than zero.");
+
+	struct Node
+	{
+		Node* Next{};
+	};
+	struct Page
+	{
+		MemoryBlock Data;
+		Page*		Next;
+	};
+
+	static constexpr size_t PREFIX_SIZE = RoundToAligned(sizeof(intptr_t));
+	static constexpr size_t SLOT_SIZE	= PREFIX_SIZE + RoundToAligned(BlockSize);
+	static constexpr size_t PAGE_SIZE	= RoundToAligned(sizeof(Page)) + SLOT_SIZE * PageCapacity;
+
+	TSupportAllocator mAllocator{};
+	Node*			  mLocalFree{};
+	Page*			  mPages{};
+	uint8_t*		  mCursor{};
+	uint8_t*		  mEnd{};
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<Node*> mRemoteFree{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = PREFIX_SIZE;
+
+public:
+	OwnerHeapAllocator() = default;
+
+	~OwnerHeapAllocator()
+	{
+		while (mPages)
+		{
+			Page*		lNext = mPages->Next;
+			MemoryBlock lData = mPages->Data;
+			mAllocator.Deallocate(lData);
+			mPages = lNext;
+		}
+	}
+
+	OwnerHeapAllocator(const OwnerHeapAllocator&)			 = delete;
+	OwnerHeapAllocator& operator=(const OwnerHeapAllocator&) = delete;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		if (Size > BlockSize || Alignment > PREFIX_SIZE)
+			return MemoryBlock{};
+		if (!mLocalFree && !ReclaimRemote() && mCursor == mEnd && !AllocatePage())
+			return MemoryBlock{};
+
+		uint8_t* lPtr;
+		if (mLocalFree)
+		{
+			lPtr	   = reinterpret_cast<uint8_t*>(mLocalFree);
+			mLocalFree = mLocalFree->Next;
+		}
+		else
+		{
+			lPtr								  = mCursor + PREFIX_SIZE;
+			*reinterpret_cast<intptr_t*>(mCursor) = reinterpret_cast<intptr_t>(this);
+			mCursor += SLOT_SIZE;
+		}
+		return MemoryBlock{lPtr, Size};
+	}
+
+	/**
+	 * @brief Releases a block from the calling thread, which must be the owner of this heap.
+	 *
+	 * Blocks owned by this heap go straight to the local free list. Blocks owned by another heap are handed to that
+	 * heap's remote-free list.
+	 *
+	 */
+	void Deallocate(MemoryBlock& Mb)
+	{
+		if (!Mb.Ptr)
+			return;
+		OwnerHeapAllocator* lOwner = OwnerOf(Mb);
+		Node*				lNode  = reinterpret_cast<Node*>(Mb.Ptr);
+		if (lOwner == this)
+		{
+			lNode->Next = mLocalFree;
+			mLocalFree	= lNode;
+		}
+		else
+		{
+			lOwner->DeallocateRemote(lNode);
+		}
+		Mb = {};
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return OwnerOf(Mb) == this;
+	}
+
+private:
+	static BC_INLINE OwnerHeapAllocator* OwnerOf(MemoryBlock Mb)
+	{
+		return reinterpret_cast<OwnerHeapAllocator*>(*reinterpret_cast<intptr_t*>(Mb.Ptr - PREFIX_SIZE));
+	}
+
+	void DeallocateRemote(Node* Value)
+	{
+		Node* lHead = mRemoteFree.load(std::memory_order_relaxed);
+		do
+		{
+			Value->Next = lHead;
+		} while (!mRemoteFree.compare_exchange_weak(lHead, Value, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	bool ReclaimRemote()
+	{
+		// Cheap relaxed peek first so an empty remote list never costs a read-modify-write.
+		if (!mRemoteFree.load(std::memory_order_relaxed))
+			return false;
+		mLocalFree = mRemoteFree.exchange(nullptr, std::memory_order_acquire);
+		return mLocalFree != nullptr;
+	}
+
+	bool AllocatePage()
+	{
+		const MemoryBlock lData = mAllocator.Allocate(PAGE_SIZE, PREFIX_SIZE);
+		if (!lData.Ptr)
+			return false;
+		Page* lPage = reinterpret_cast<Page*>(lData.Ptr);
+		lPage->Data = lData;
+		lPage->Next = mPages;
+		mPages		= lPage;
+		mCursor		= lData.Ptr + RoundToAligned(sizeof(Page));
+		mEnd		= mCursor + SLOT_SIZE * PageCapacity;
+		return true;
+	}
+};
+
+/**
+ * @brief Guarantees Align aligned blocks whatever TSupportAllocator natively honors.
+ *
+ * When Align fits TSupportAllocator's MAX_ALIGNMENT the request is forwarded as is. Otherwise the block is
+ * over-allocated by Align bytes and a prefix right before the aligned pointer keeps the distance back to the start of
+ * the support block and the size the support allocator returned, so Deallocate hands it back exactly.
+ *
+ * Owns is only as precise as TSupportAllocator::Owns. It reads the prefix of a block once the support allocator claims
+ * the bytes holding it, so over an allocator claiming everything, like Mallocator, it must only be asked about blocks
+ * this allocator returned. Compose it with an allocator whose Owns tells blocks apart before routing foreign ones.
+ *
+ */
+template<typename TSupportAllocator, size_t Align>
+class AlignedAllocator
+{
+	static_assert(IsPowerOfTwo(Align), "Align needs to be a power of two.");
+
+	struct Prefix
+	{
+		size_t	 RawSize;
+		uint32_t Offset;
+	};
+
+	static constexpr bool	NATIVE		= Align <= AllocatorMaxAlignment<TSupportAllocator>::value;
+	static constexpr size_t PREFIX_SIZE = sizeof(Prefix);
+	static constexpr size_t PADDING		= NATIVE ? 0 : Align + PREFIX_SIZE - 1;
+
+	TSupportAllocator mAllocator{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = Align;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = Align)
+	{
+		assert(IsPowerOfTwo(Alignment) && Alignment <= Align && "Alignment greater than Align.");
+		UNUSED(Alignment);
+		const MemoryBlock lMemoryBlock = mAllocator.Allocate(Size + PADDING, NATIVE ? Align : alignof(Prefix));
+		if (!lMemoryBlock.Ptr)
+			return MemoryBlock{};
+		if constexpr (NATIVE)
+		{
+			assert(IsAligned(lMemoryBlock.Ptr, Align) && "Support allocator broke its alignment contract.");
+			return lMemoryBlock;
+		}
+		else
+		{
+			uint8_t* lPtr = reinterpret_cast<uint8_t*>(
+				RoundToAligned(reinterpret_cast<uintptr_t>(lMemoryBlock.Ptr + PREFIX_SIZE), Align));
+			const Prefix lPrefix{lMemoryBlock.Size, static_cast<uint32_t>(lPtr - lMemoryBlock.Ptr)};
+			BC_MEMCPY(lPtr - PREFIX_SIZE, &lPrefix, PREFIX_SIZE);
+			return MemoryBlock{lPtr, Size};
+		}
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		if (!Mb.Ptr)
+			return;
+		MemoryBlock lMemoryBlock = RawBlock(Mb);
+		mAllocator.Deallocate(lMemoryBlock);
+		Mb = {};
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		if (!Mb.Ptr)
+			return false;
+		if constexpr (NATIVE)
+			return mAllocator.Owns(Mb);
+		else
+		{
+			// The prefix is only read once the support allocator claims the bytes holding it, see the class comment.
+			return mAllocator.Owns(MemoryBlock{Mb.Ptr - PREFIX_SIZE, PREFIX_SIZE}) && mAllocator.Owns(RawBlock(Mb));
+		}
+	}
+
+private:
+	static BC_INLINE MemoryBlock RawBlock(MemoryBlock Mb)
+	{
+		if constexpr (NATIVE)
+			return Mb;
+		else
+		{
+			Prefix lPrefix;
+			BC_MEMCPY(&lPrefix, Mb.Ptr - PREFIX_SIZE, PREFIX_SIZE);
+			return MemoryBlock{Mb.Ptr - lPrefix.Offset, lPrefix.RawSize};
+		}
+	}
+};
+
+/**
+ * @brief Non-owning, type-erased handle to any allocator exposing Allocate, Deallocate and Owns.
+ *
+ * Calls go through a static function table per allocator type, so every container or helper taking an AllocatorRef
+ * is instantiated once whatever allocator stands behind it. Meant for cold and medium paths, hot paths keep the
+ * allocator type to get fully inlined calls. The referenced allocator has to outlive the reference.
+ *
+ */
+class AllocatorRef
+{
+	struct FunctionTable
+	{
+		MemoryBlock (*Allocate)(void* Allocator, size_t Size, size_t Alignment);
+		void (*Deallocate)(void* Allocator, MemoryBlock& Mb);
+		bool (*Owns)(const void* Allocator, MemoryBlock Mb);
+		size_t MaxAlignment;
+	};
+
+	template<typename TAllocator>
+	struct Functions
+	{
+		static MemoryBlock Allocate(void* Allocator, const size_t Size, const size_t Alignment)
+		{
+			return static_cast<TAllocator*>(Allocator)->Allocate(Size, Alignment);
+		}
+		static void Deallocate(void* Allocator, MemoryBlock& Mb)
+		{
+			static_cast<TAllocator*>(Allocator)->Deallocate(Mb);
+			Mb = {};
+		}
+		static bool Owns(const void* Allocator, const MemoryBlock Mb)
+		{
+			return static_cast<const TAllocator*>(Allocator)->Owns(Mb);
+		}
+
+		static constexpr FunctionTable TABLE{&Allocate, &Deallocate, &Owns, AllocatorMaxAlignment<TAllocator>::value};
+	};
+
+	void*				 mAllocator{};
+	const FunctionTable* mTable{};
+
+public:
+	AllocatorRef() = default;
+
+	template<typename TAllocator, typename = std::enable_if_t<!std::is_same_v<TAllocator, AllocatorRef>>>
+	AllocatorRef(TAllocator& Allocator) : mAllocator{&Allocator}, mTable{&Functions<TAllocator>::TABLE}
+	{
+	}
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		assert(mTable && "Empty allocator reference.");
+		return mTable->Allocate(mAllocator, Size, Alignment);
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		assert(mTable && "Empty allocator reference.");
+		mTable->Deallocate(mAllocator, Mb);
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return mTable && mTable->Owns(mAllocator, Mb);
+	}
+
+	// Runtime counterpart of the referenced allocator's MAX_ALIGNMENT.
+	[[nodiscard]] size_t MaxAlignment() const
+	{
+		return mTable ? mTable->MaxAlignment : 0;
+	}
+
+	BC_INLINE BC_EXPLICIT operator bool() const
+	{
+		return mTable != nullptr;
 	}
 };
 
@@ -318,7 +1761,7 @@ class AffixAllocator
 
 public:
 	MemoryBlock Allocate(size_t Size, InternalPrefix&& Prefix, InternalSuffix&& Suffix,
-						 size_t Alignment = sizeof(std::max_align_t))
+						 size_t Alignment = alignof(std::max_align_t))
 	{
 		auto lMb = mAllocator.Allocate(sizeof(InternalPrefix) + sizeof(InternalSuffix) + Size, Alignment);
 		Prefix.AllocatorAddress														= reinterpret_cast<intptr_t>(this);
@@ -0,0 +1,143 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Throughput and latency benchmark for SpscQueue and MpmcQueue.
+// Build: g++ -std=c++17 -O2 -DNDEBUG -pthread -I.. QueueBenchmark.cpp -o QueueBenchmark
+// Usage: QueueBenchmark [messages per run]
+
+#include "Queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+static constexpr size_t QUEUE_CAPACITY = 1024;
+static constexpr size_t LATENCY_STRIDE = 64;
+
+struct RunStats
+{
+	double				  MessagesPerSecond;
+	std::vector<uint64_t> Latencies;
+};
+
+static uint64_t NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+template<typename TQueue>
+static RunStats Run(const size_t Producers, const size_t Consumers, const size_t Messages)
+{
+	TQueue				lQueue{QUEUE_CAPACITY};
+	std::atomic<size_t> lConsumed{};
+	std::atomic<bool>	lStart{};
+
+	std::vector<std::vector<uint64_t>> lLatencies(Consumers);
+	std::vector<std::thread>		   lThreads;
+
+	const size_t lPerProducer = Messages / Producers;
+	const size_t lTotal		  = lPerProducer * Producers;
+
+	for (size_t lIndex = 0; lIndex < Producers; ++lIndex)
+	{
+		lThreads.emplace_back([&] {
+			while (!lStart.load(std::memory_order_acquire))
+				;
+			for (size_t lMessage = 0; lMessage < lPerProducer; ++lMessage)
+			{
+				const uint64_t lStamp = lMessage % LATENCY_STRIDE == 0 ? NowNs() : 0;
+				while (!lQueue.TryPush(lStamp))
+					std::this_thread::yield();
+			}
+		});
+	}
+	for (size_t lIndex = 0; lIndex < Consumers; ++lIndex)
+	{
+		lThreads.emplace_back([&, lIndex] {
+			std::vector<uint64_t>& lSamples = lLatencies[lIndex];
+			lSamples.reserve(lTotal / LATENCY_STRIDE / Consumers + 1);
+			while (!lStart.load(std::memory_order_acquire))
+				;
+			uint64_t lStamp;
+			while (lConsumed.load(std::memory_order_relaxed) < lTotal)
+			{
+				if (!lQueue.TryPop(lStamp))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				if (lStamp)
+					lSamples.push_back(NowNs() - lStamp);
+				lConsumed.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	const auto lBegin = clock_type::now();
+	lStart.store(true, std::memory_order_release);
+	for (std::thread& lThread : lThreads)
+		lThread.join();
+	const double lSeconds = std::chrono::duration<double>(clock_type::now() - lBegin).count();
+
+	RunStats lStats{static_cast<double>(lTotal) / lSeconds, {}};
+	for (const std::vector<uint64_t>& lSamples : lLatencies)
+		lStats.Latencies.insert(lStats.Latencies.end(), lSamples.begin(), lSamples.end());
+	std::sort(lStats.Latencies.begin(), lStats.Latencies.end());
+	return lStats;
+}
+
+static uint64_t Percentile(const std::vector<uint64_t>& Sorted, const double Fraction)
+{
+	if (Sorted.empty())
+		return 0;
+	return Sorted[std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * Sorted.size()))];
+}
+
+static void Report(const char* Name, const size_t Producers, const size_t Consumers, const RunStats& Stats)
+{
+	printf("%-6s %3zu %3zu %12.2f %10llu %10llu %10llu %10llu\n", Name, Producers, Consumers,
+		   Stats.MessagesPerSecond / 1e6, static_cast<unsigned long long>(Percentile(Stats.Latencies, 0.5)),
+		   static_cast<unsigned long long>(Percentile(Stats.Latencies, 0.99)),
+		   static_cast<unsigned long long>(Percentile(Stats.Latencies, 0.999)),
+		   static_cast<unsigned long long>(Stats.Latencies.empty() ? 0 : Stats.Latencies.back()));
+}
+
+int main(int Argc, char** Argv)
+{
+	const size_t lMessages = Argc > 1 ? strtoull(Argv[1], nullptr, 10) : 10000000;
+	const size_t lThreads  = std::max(2u, std::thread::hardware_concurrency());
+
+	printf("%-6s %3s %3s %12s %10s %10s %10s %10s\n", "Queue", "P", "C", "Mmsg/s", "p50 ns", "p99 ns", "p99.9 ns",
+		   "max ns");
+	Report("SPSC", 1, 1, Run<SpscQueue<uint64_t>>(1, 1, lMessages));
+	for (size_t lProducers = 1; lProducers < lThreads; lProducers *= 2)
+		for (size_t lConsumers = 1; lProducers + lConsumers <= lThreads; lConsumers *= 2)
+			Report("MPMC", lProducers, lConsumers, Run<MpmcQueue<uint64_t>>(lProducers, lConsumers, lMessages));
+	return 0;
+}
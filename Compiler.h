@@ -34,12 +34,32 @@
 #define BC_LANGUAGE_CPP23 202207L
 
 #if _MSC_VER
-#define BC_INLINE __forceinline
+#define BC_INLINE	__forceinline
+#define BC_NOINLINE __declspec(noinline)
+#define BC_COLD
 #else
-#define BC_INLINE __attribute__((always_inline))
+#define BC_INLINE	inline __attribute__((always_inline))
+#define BC_NOINLINE __attribute__((noinline))
+#define BC_COLD		__attribute__((cold))
 #endif
 
 #define BC_CONSTEXPR constexpr
 #define BC_EXPLICIT	 explicit
 
+#if defined(_MSVC_LANG)
+#define BC_LANGUAGE_VERSION _MSVC_LANG
+#else
+#define BC_LANGUAGE_VERSION __cplusplus
+#endif
+
+// constexpr only under C++20, whose constant evaluation allows std::is_constant_evaluated, transient allocations and
+// std::construct_at. Code testing BC_IS_CONSTANT_EVALUATED needs <type_traits>.
+#if BC_LANGUAGE_VERSION >= BC_LANGUAGE_CPP20
+#define BC_CONSTEXPR20				 constexpr
+#define BC_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define BC_CONSTEXPR20
+#define BC_IS_CONSTANT_EVALUATED() false
+#endif
+
 #endif
@@ -0,0 +1,158 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_COROUTINE_H
+#define BC_COROUTINE_H
+
+#include "Allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+
+/**
+ * @brief Promise type mixin routing coroutine frames through TFrameAllocator instead of global new.
+ *
+ * Derive the promise_type from it, e.g. struct promise_type: CoroutineFrameAllocator<FreeListAllocator<Mallocator, 512,
+ * 256, 512>> {...}. Each thread lazily owns a default constructed TFrameAllocator (a PoolAllocator needs a wrapper
+ * passing its capacity), and frames it cannot serve, such as oversized ones, go to TFallbackAllocator, which has to be
+ * thread safe. A frame destroyed on another thread is pushed onto its owner's lock-free remote list and handed back
+ * on the owner's next frame allocation, so the allocating thread has to outlive the frames it created.
+ *
+ */
+template<typename TFrameAllocator, typename TFallbackAllocator = Mallocator>
+class CoroutineFrameAllocator
+{
+	struct FrameHeap;
+
+	// Lives right before the frame. Next links it on the owner's remote list once the frame is dead.
+	struct FrameHeader
+	{
+		union
+		{
+			FrameHeap*	 Heap;
+			FrameHeader* Next;
+		};
+		size_t Size;
+	};
+
+	static constexpr size_t FRAME_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	static constexpr size_t HEADER_SIZE		= RoundToAligned(sizeof(FrameHeader), FRAME_ALIGNMENT);
+
+	struct FrameHeap
+	{
+		TFrameAllocator			  Allocator{};
+		std::atomic<FrameHeader*> RemoteFree{};
+
+		FrameHeap()
+		{
+			ThreadHeap() = this;
+		}
+		~FrameHeap()
+		{
+			ReclaimRemote();
+			ThreadHeap() = nullptr;
+		}
+
+		void ReclaimRemote()
+		{
+			FrameHeader* lHeader = RemoteFree.exchange(nullptr, std::memory_order_acquire);
+			while (lHeader)
+			{
+				FrameHeader* lNext = lHeader->Next;
+				MemoryBlock	 lMb{reinterpret_cast<uint8_t*>(lHeader), lHeader->Size};
+				Allocator.Deallocate(lMb);
+				lHeader = lNext;
+			}
+		}
+	};
+
+public:
+	static void* operator new(const size_t Size)
+	{
+		FrameHeap& lHeap = LocalHeap();
+		if (lHeap.RemoteFree.load(std::memory_order_relaxed))
+			lHeap.ReclaimRemote();
+		MemoryBlock lMemoryBlock = lHeap.Allocator.Allocate(HEADER_SIZE + Size, FRAME_ALIGNMENT);
+		FrameHeap*	lOwner		 = &lHeap;
+		if (!lMemoryBlock.Ptr)
+		{
+			lMemoryBlock = Fallback().Allocate(HEADER_SIZE + Size, FRAME_ALIGNMENT);
+			lOwner		 = nullptr;
+		}
+		if (!lMemoryBlock.Ptr)
+		{
+			assert(false && "Out of memory for coroutine frame.");
+			std::abort();
+		}
+		FrameHeader* lHeader = reinterpret_cast<FrameHeader*>(lMemoryBlock.Ptr);
+		lHeader->Heap		 = lOwner;
+		lHeader->Size		 = lMemoryBlock.Size;
+		return lMemoryBlock.Ptr + HEADER_SIZE;
+	}
+
+	static void operator delete(void* Ptr, const size_t Size) noexcept
+	{
+		UNUSED(Size);
+		if (!Ptr)
+			return;
+		FrameHeader* lHeader = reinterpret_cast<FrameHeader*>(static_cast<uint8_t*>(Ptr) - HEADER_SIZE);
+		FrameHeap*	 lOwner	 = lHeader->Heap;
+		MemoryBlock	 lMb{reinterpret_cast<uint8_t*>(lHeader), lHeader->Size};
+		if (!lOwner)
+			Fallback().Deallocate(lMb);
+		else if (lOwner == ThreadHeap())
+			lOwner->Allocator.Deallocate(lMb);
+		else
+		{
+			lHeader->Next = lOwner->RemoteFree.load(std::memory_order_relaxed);
+			while (!lOwner->RemoteFree.compare_exchange_weak(lHeader->Next, lHeader, std::memory_order_release,
+															 std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+private:
+	static FrameHeap& LocalHeap()
+	{
+		thread_local FrameHeap lHeap{};
+		return lHeap;
+	}
+
+	// Set once the calling thread created its heap, so foreign frees never create one.
+	static FrameHeap*& ThreadHeap()
+	{
+		thread_local FrameHeap* lHeap{};
+		return lHeap;
+	}
+
+	static TFallbackAllocator& Fallback()
+	{
+		static TFallbackAllocator lAllocator{};
+		return lAllocator;
+	}
+};
+
+#endif
@@ -0,0 +1,377 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_EPOCH_H
+#define BC_EPOCH_H
+
+#include "Allocator.h"
+
+#include <atomic>
+#include <mutex>
+
+/**
+ * @brief Epoch based reclamation domain for nodes of lock-free structures.
+ *
+ * Threads Register a participant once, Pin it around every read of shared nodes (see Guard) and Retire the nodes
+ * they unlinked. A node retired in epoch E can no longer be reached once the global epoch reaches E + 2, which only
+ * happens after every pinned participant observed E + 1. Retired nodes are buffered per participant in three bags,
+ * one per live epoch, and a bag reaching BatchSize nodes tries to advance the epoch and reclaims the expired bags.
+ *
+ * Reclaimed blocks first refill the participant's own cache served by Allocate, so steady state allocation and
+ * reclamation stay thread local. TAllocator is only touched under a lock, in batches, when that cache runs dry or
+ * overflows, which makes a plain PoolAllocator or FreeListAllocator a valid backing allocator. Constructor arguments
+ * are forwarded to it, e.g. EpochDomain<PoolAllocator<64, Mallocator>> lDomain{4096}.
+ *
+ */
+template<typename TAllocator = Mallocator, size_t MaxThreads = 64, size_t BatchSize = 64>
+class EpochDomain
+{
+	static_assert(MaxThreads > 0 && BatchSize > 0, "Invalid EpochDomain configuration.");
+
+	static constexpr size_t BAG_COUNT	= 3;
+	static constexpr size_t CACHE_LIMIT = BatchSize * 4;
+
+	struct Retired
+	{
+		MemoryBlock Block;
+		void (*Destroy)(void*);
+	};
+
+	// Growable array of retired nodes, storage comes from a Mallocator so it never competes with TAllocator.
+	struct Bag
+	{
+		uint64_t Epoch{};
+		Retired* Data{};
+		size_t	 Size{};
+		size_t	 Capacity{};
+	};
+
+public:
+	class alignas(BC_CACHE_LINE_SIZE) Participant
+	{
+		friend class EpochDomain;
+
+		std::atomic<uint64_t> mState{}; // (Epoch << 1) | 1 while pinned, 0 otherwise.
+		std::atomic<bool>	  mRegistered{};
+		uint32_t			  mPinDepth{};
+		Bag					  mBags[BAG_COUNT]{};
+		Bag					  mCache{};
+	};
+
+	/**
+	 * @brief Keeps Thread pinned for its lifetime, nodes read meanwhile stay valid.
+	 *
+	 */
+	class Guard
+	{
+		EpochDomain& mDomain;
+		Participant* mThread;
+
+	public:
+		Guard(EpochDomain& Domain, Participant* Thread) : mDomain{Domain}, mThread{Thread}
+		{
+			mDomain.Pin(mThread);
+		}
+		~Guard()
+		{
+			mDomain.Unpin(mThread);
+		}
+
+		Guard(const Guard&)			   = delete;
+		Guard& operator=(const Guard&) = delete;
+	};
+
+private:
+	TAllocator mAllocator{};
+	std::mutex mAllocatorMutex{};
+	Mallocator mBagAllocator{};
+	Bag		   mOrphans[BAG_COUNT]{};
+	std::mutex mOrphanMutex{};
+
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<uint64_t> mEpoch{1};
+	std::atomic<size_t> mParticipantCount{};
+	Participant			mParticipants[MaxThreads]{};
+
+public:
+	EpochDomain() = default;
+
+	template<typename... TArgs, std::enable_if_t<std::is_constructible_v<TAllocator, TArgs...>, int> = 0>
+	explicit EpochDomain(TArgs&&... Args) : mAllocator(std::forward<TArgs>(Args)...)
+	{
+	}
+
+	~EpochDomain()
+	{
+		for (size_t lIndex = 0; lIndex < MaxThreads; ++lIndex)
+		{
+			Participant& lThread = mParticipants[lIndex];
+			for (Bag& lBag : lThread.mBags)
+				ReleaseBag(lBag);
+			ReleaseBag(lThread.mCache);
+		}
+		for (Bag& lBag : mOrphans)
+			ReleaseBag(lBag);
+	}
+
+	EpochDomain(const EpochDomain&)			   = delete;
+	EpochDomain& operator=(const EpochDomain&) = delete;
+
+public:
+	/**
+	 * @brief Claims a participant for the calling thread, or returns nullptr when MaxThreads are already registered.
+	 *
+	 */
+	Participant* Register()
+	{
+		for (size_t lIndex = 0; lIndex < MaxThreads; ++lIndex)
+		{
+			bool lRegistered = false;
+			if (!mParticipants[lIndex].mRegistered.compare_exchange_strong(lRegistered, true,
+																		   std::memory_order_acq_rel))
+				continue;
+			size_t lCount = mParticipantCount.load(std::memory_order_relaxed);
+			while (lCount <= lIndex && !mParticipantCount.compare_exchange_weak(lCount, lIndex + 1))
+			{
+			}
+			return &mParticipants[lIndex];
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief Releases Thread. Nodes it retired that are not reclaimable yet are handed over to the domain.
+	 *
+	 */
+	void Unregister(Participant* Thread)
+	{
+		assert(Thread && !Thread->mPinDepth && "Unregistering a pinned participant.");
+		for (size_t lTry = 0; lTry < BAG_COUNT; ++lTry)
+		{
+			TryAdvance();
+			Collect(Thread);
+		}
+		{
+			std::lock_guard<std::mutex> lLock{mOrphanMutex};
+			for (size_t lIndex = 0; lIndex < BAG_COUNT; ++lIndex)
+				MergeBag(mOrphans[lIndex], Thread->mBags[lIndex]);
+		}
+		{
+			std::lock_guard<std::mutex> lLock{mAllocatorMutex};
+			ReleaseBlocks(Thread->mCache, 0);
+		}
+		Thread->mRegistered.store(false, std::memory_order_release);
+	}
+
+	BC_INLINE void Pin(Participant* Thread)
+	{
+		if (Thread->mPinDepth++)
+			return;
+		const uint64_t lEpoch = mEpoch.load(std::memory_order_relaxed);
+		Thread->mState.store((lEpoch << 1) | 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	BC_INLINE void Unpin(Participant* Thread)
+	{
+		assert(Thread->mPinDepth && "Unbalanced Unpin.");
+		if (!--Thread->mPinDepth)
+			Thread->mState.store(0, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Allocates a node, from the blocks Thread reclaimed when one fits, else from TAllocator.
+	 *
+	 */
+	MemoryBlock Allocate(Participant* Thread, size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		if (Thread && Thread->mCache.Size)
+		{
+			const MemoryBlock lBlock = Thread->mCache.Data[Thread->mCache.Size - 1].Block;
+			if (lBlock.Size >= Size && IsAligned(lBlock.Ptr, Alignment))
+			{
+				--Thread->mCache.Size;
+				return lBlock;
+			}
+		}
+		std::lock_guard<std::mutex> lLock{mAllocatorMutex};
+		return mAllocator.Allocate(Size, Alignment);
+	}
+
+	/**
+	 * @brief Defers the release of Block, already unlinked from the shared structure, until no reader can see it.
+	 *
+	 * Destroy, when set, runs on the block right before it is reclaimed.
+	 *
+	 */
+	void Retire(Participant* Thread, const MemoryBlock Block, void (*Destroy)(void*) = nullptr)
+	{
+		const uint64_t lEpoch = mEpoch.load(std::memory_order_seq_cst);
+		Bag&		   lBag	  = Thread->mBags[lEpoch % BAG_COUNT];
+		if (lBag.Size && lBag.Epoch != lEpoch)
+			ReclaimBag(Thread, lBag);
+		lBag.Epoch = lEpoch;
+		PushBack(lBag, Retired{Block, Destroy});
+		if (lBag.Size >= BatchSize)
+		{
+			TryAdvance();
+			Collect(Thread);
+		}
+	}
+
+	template<typename T>
+	void Retire(Participant* Thread, T* Object, const size_t Size = sizeof(T))
+	{
+		void (*lDestroy)(void*) = nullptr;
+		if constexpr (!std::is_trivially_destructible_v<T>)
+			lDestroy = [](void* Ptr) { static_cast<T*>(Ptr)->~T(); };
+		Retire(Thread, MemoryBlock{reinterpret_cast<uint8_t*>(Object), Size}, lDestroy);
+	}
+
+	/**
+	 * @brief Advances the global epoch when every pinned participant observed the current one.
+	 *
+	 */
+	bool TryAdvance()
+	{
+		uint64_t lEpoch = mEpoch.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const size_t lCount = mParticipantCount.load(std::memory_order_acquire);
+		for (size_t lIndex = 0; lIndex < lCount; ++lIndex)
+		{
+			const uint64_t lState = mParticipants[lIndex].mState.load(std::memory_order_relaxed);
+			if ((lState & 1) && (lState >> 1) != lEpoch)
+				return false;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return mEpoch.compare_exchange_strong(lEpoch, lEpoch + 1, std::memory_order_release,
+											  std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Reclaims the bags of Thread, and of unregistered threads, retired two or more epochs ago.
+	 *
+	 */
+	void Collect(Participant* Thread)
+	{
+		const uint64_t lEpoch = mEpoch.load(std::memory_order_acquire);
+		for (Bag& lBag : Thread->mBags)
+		{
+			if (lBag.Size && lBag.Epoch + 2 <= lEpoch)
+				ReclaimBag(Thread, lBag);
+		}
+		if (!mOrphanMutex.try_lock())
+			return;
+		for (Bag& lBag : mOrphans)
+		{
+			if (lBag.Size && lBag.Epoch + 2 <= lEpoch)
+				ReclaimBag(Thread, lBag);
+		}
+		mOrphanMutex.unlock();
+	}
+
+	[[nodiscard]] uint64_t Epoch() const
+	{
+		return mEpoch.load(std::memory_order_relaxed);
+	}
+
+private:
+	void ReclaimBag(Participant* Thread, Bag& Value)
+	{
+		for (size_t lIndex = 0; lIndex < Value.Size; ++lIndex)
+		{
+			Retired& lRetired = Value.Data[lIndex];
+			if (lRetired.Destroy)
+				lRetired.Destroy(lRetired.Block.Ptr);
+			lRetired.Destroy = nullptr;
+			PushBack(Thread->mCache, lRetired);
+		}
+		Value.Size = 0;
+		if (Thread->mCache.Size > CACHE_LIMIT)
+		{
+			std::lock_guard<std::mutex> lLock{mAllocatorMutex};
+			ReleaseBlocks(Thread->mCache, CACHE_LIMIT / 2);
+		}
+	}
+
+	// Hands the blocks of Value past Keep back to TAllocator, mAllocatorMutex must be held.
+	void ReleaseBlocks(Bag& Value, const size_t Keep)
+	{
+		while (Value.Size > Keep)
+		{
+			MemoryBlock lBlock = Value.Data[--Value.Size].Block;
+			mAllocator.Deallocate(lBlock);
+		}
+	}
+
+	// Only called once no thread can read the blocks anymore.
+	void ReleaseBag(Bag& Value)
+	{
+		for (size_t lIndex = 0; lIndex < Value.Size; ++lIndex)
+		{
+			Retired& lRetired = Value.Data[lIndex];
+			if (lRetired.Destroy)
+				lRetired.Destroy(lRetired.Block.Ptr);
+			mAllocator.Deallocate(lRetired.Block);
+		}
+		if (Value.Data)
+		{
+			MemoryBlock lData{reinterpret_cast<uint8_t*>(Value.Data), sizeof(Retired) * Value.Capacity};
+			mBagAllocator.Deallocate(lData);
+		}
+		Value = {};
+	}
+
+	// Merging keeps the later epoch, which can only delay reclamation.
+	void MergeBag(Bag& Destination, Bag& Source)
+	{
+		if (!Source.Size)
+			return;
+		for (size_t lIndex = 0; lIndex < Source.Size; ++lIndex)
+			PushBack(Destination, Source.Data[lIndex]);
+		Destination.Epoch = Destination.Epoch > Source.Epoch ? Destination.Epoch : Source.Epoch;
+		Source.Size		  = 0;
+	}
+
+	void PushBack(Bag& Value, const Retired& Item)
+	{
+		if (Value.Size == Value.Capacity)
+		{
+			const size_t	  lCapacity = Value.Capacity ? Value.Capacity * 2 : BatchSize;
+			const MemoryBlock lData		= mBagAllocator.Allocate(sizeof(Retired) * lCapacity, alignof(Retired));
+			assert(lData.Ptr && "Out of memory for retired nodes.");
+			if (Value.Data)
+			{
+				BC_MEMCPY(lData.Ptr, Value.Data, sizeof(Retired) * Value.Size);
+				MemoryBlock lOld{reinterpret_cast<uint8_t*>(Value.Data), sizeof(Retired) * Value.Capacity};
+				mBagAllocator.Deallocate(lOld);
+			}
+			Value.Data	   = reinterpret_cast<Retired*>(lData.Ptr);
+			Value.Capacity = lCapacity;
+		}
+		Value.Data[Value.Size++] = Item;
+	}
+};
+
+#endif
@@ -0,0 +1,412 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_HASH_MAP_H
+#define BC_HASH_MAP_H
+
+#include "Allocator.h"
+
+#include <functional>
+
+#if BC_CPU_X86 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define BC_HASH_MAP_SSE2 1
+#else
+#define BC_HASH_MAP_SSE2 0
+#endif
+
+/**
+ * @brief Flat open addressing hash map probing groups of control bytes at a time.
+ *
+ * SwissTable layout: one control byte per slot holds either an empty/deleted marker or the low 7 bits of the key hash,
+ * and lookups compare a whole group of control bytes at once, 16 with one SSE2 compare or 8 with 64-bit SWAR on other
+ * CPUs, before touching any key. Control bytes and entries share a single block taken from TAllocator; pass a
+ * reference type such as StackAllocator<N>& to keep the table in an arena owned elsewhere, and call Abandon before
+ * resetting that arena so the whole table goes away without any per-entry work.
+ *
+ */
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>, typename TAllocator = Mallocator>
+class HashMap
+{
+public:
+	struct Entry
+	{
+		TKey   Key;
+		TValue Value;
+	};
+
+private:
+#if BC_HASH_MAP_SSE2
+	static constexpr size_t GROUP_SIZE	= 16;
+	static constexpr size_t GROUP_SHIFT = 0;
+#else
+	static constexpr size_t GROUP_SIZE	= 8;
+	static constexpr size_t GROUP_SHIFT = 3;
+#endif
+	static constexpr size_t NOT_FOUND	 = ~size_t{0};
+	static constexpr int8_t CTRL_EMPTY	 = -128;
+	static constexpr int8_t CTRL_DELETED = -2;
+
+	// Match masks hold one bit per slot, slot index is FindFirstSet(Mask) >> GROUP_SHIFT.
+	struct Group
+	{
+#if BC_HASH_MAP_SSE2
+		__m128i Ctrl;
+
+		BC_INLINE BC_EXPLICIT Group(const int8_t* Position)
+			: Ctrl{_mm_load_si128(reinterpret_cast<const __m128i*>(Position))}
+		{
+		}
+		BC_INLINE uint64_t Match(const int8_t H2) const
+		{
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Ctrl, _mm_set1_epi8(H2))));
+		}
+		BC_INLINE uint64_t MatchEmpty() const
+		{
+			return Match(CTRL_EMPTY);
+		}
+		BC_INLINE uint64_t MatchNonFull() const
+		{
+			return static_cast<uint32_t>(_mm_movemask_epi8(Ctrl));
+		}
+#else
+		// 64-bit SWAR over 8 control bytes, Match may report false positives on full slots, keys are compared anyway.
+		static constexpr uint64_t LSBS = 0x0101010101010101ull;
+		static constexpr uint64_t MSBS = 0x8080808080808080ull;
+
+		uint64_t Ctrl;
+
+		BC_INLINE BC_EXPLICIT Group(const int8_t* Position)
+		{
+			BC_MEMCPY(&Ctrl, Position, sizeof(Ctrl));
+		}
+		BC_INLINE uint64_t Match(const int8_t H2) const
+		{
+			const uint64_t lValue = Ctrl ^ (LSBS * static_cast<uint8_t>(H2));
+			return (lValue - LSBS) & ~lValue & MSBS;
+		}
+		BC_INLINE uint64_t MatchEmpty() const
+		{
+			return Ctrl & ~(Ctrl << 6) & MSBS;
+		}
+		BC_INLINE uint64_t MatchNonFull() const
+		{
+			return Ctrl & MSBS;
+		}
+#endif
+	};
+
+	TAllocator	mAllocator;
+	MemoryBlock mData{};
+	int8_t*		mCtrl{};
+	Entry*		mEntries{};
+	size_t		mCapacity{};
+	size_t		mSize{};
+	size_t		mGrowthLeft{};
+
+public:
+	class Iterator
+	{
+		friend class HashMap;
+		const HashMap* mMap{};
+		size_t		   mIndex{};
+
+		Iterator(const HashMap* Map, const size_t Index) : mMap{Map}, mIndex{Index}
+		{
+			SkipNonFull();
+		}
+		void SkipNonFull()
+		{
+			while (mIndex < mMap->mCapacity && mMap->mCtrl[mIndex] < 0)
+				++mIndex;
+		}
+
+	public:
+		Entry& operator*() const
+		{
+			return mMap->mEntries[mIndex];
+		}
+		Entry* operator->() const
+		{
+			return &mMap->mEntries[mIndex];
+		}
+		Iterator& operator++()
+		{
+			++mIndex;
+			SkipNonFull();
+			return *this;
+		}
+		bool operator==(const Iterator& Other) const
+		{
+			return mIndex == Other.mIndex;
+		}
+		bool operator!=(const Iterator& Other) const
+		{
+			return mIndex != Other.mIndex;
+		}
+	};
+
+public:
+	HashMap() = default;
+
+	BC_EXPLICIT HashMap(TAllocator Allocator) : mAllocator{Allocator}
+	{
+	}
+
+	~HashMap()
+	{
+		Release();
+	}
+
+	HashMap(const HashMap&)			   = delete;
+	HashMap& operator=(const HashMap&) = delete;
+
+public:
+	TValue* Find(const TKey& Key) const
+	{
+		const size_t lIndex = FindIndex(Key);
+		return lIndex != NOT_FOUND ? &mEntries[lIndex].Value : nullptr;
+	}
+
+	[[nodiscard]] bool Contains(const TKey& Key) const
+	{
+		return Find(Key) != nullptr;
+	}
+
+	/**
+	 * @brief Inserts Key with a value built from Args unless it is already present.
+	 *
+	 * Returns the stored value and whether it was inserted, or a null value when the table could not grow.
+	 *
+	 */
+	template<typename... TArgs>
+	std::pair<TValue*, bool> Emplace(const TKey& Key, TArgs&&... Args)
+	{
+		if (TValue* lValue = Find(Key))
+			return {lValue, false};
+		// Out of empty slots: grow, or rebuild at the same size when tombstones are what filled the table.
+		if (!mGrowthLeft && !Rehash(mSize * 2 >= MaxLoad(mCapacity) ? mCapacity * 2 : mCapacity))
+			return {nullptr, false};
+
+		const size_t lHash	= Hash(Key);
+		const size_t lIndex = FindInsertSlot(lHash);
+		mGrowthLeft -= mCtrl[lIndex] == CTRL_EMPTY;
+		mCtrl[lIndex] = H2(lHash);
+		Entry* lEntry = new (mEntries + lIndex) Entry{Key, TValue{std::forward<TArgs>(Args)...}};
+		++mSize;
+		return {&lEntry->Value, true};
+	}
+
+	TValue& operator[](const TKey& Key)
+	{
+		TValue* lValue = Emplace(Key).first;
+		assert(lValue && "HashMap allocation failed.");
+		return *lValue;
+	}
+
+	bool Erase(const TKey& Key)
+	{
+		const size_t lIndex = FindIndex(Key);
+		if (lIndex == NOT_FOUND)
+			return false;
+		mEntries[lIndex].~Entry();
+		// A group that still has an empty slot ends every probe reaching it, so the slot can go back to empty.
+		if (Group{mCtrl + lIndex / GROUP_SIZE * GROUP_SIZE}.MatchEmpty())
+		{
+			mCtrl[lIndex] = CTRL_EMPTY;
+			++mGrowthLeft;
+		}
+		else
+		{
+			mCtrl[lIndex] = CTRL_DELETED;
+		}
+		--mSize;
+		return true;
+	}
+
+	bool Reserve(const size_t Size)
+	{
+		const size_t lCapacity = RoundToPowerOfTwo(Size + Size / 7 + 1);
+		return lCapacity <= mCapacity || Rehash(lCapacity);
+	}
+
+	void Clear()
+	{
+		if (!mCapacity)
+			return;
+		if constexpr (!std::is_trivially_destructible_v<Entry>)
+		{
+			for (size_t lIndex = 0; lIndex < mCapacity; ++lIndex)
+				if (mCtrl[lIndex] >= 0)
+					mEntries[lIndex].~Entry();
+		}
+		BC_MEMSET(mCtrl, static_cast<uint8_t>(CTRL_EMPTY), mCapacity);
+		mSize		= 0;
+		mGrowthLeft = MaxLoad(mCapacity);
+	}
+
+	/**
+	 * @brief Forgets the table without destroying entries or releasing memory.
+	 *
+	 * Meant to be called right before the backing arena is reset, which reclaims everything at once.
+	 *
+	 */
+	void Abandon()
+	{
+		mData		= {};
+		mCtrl		= nullptr;
+		mEntries	= nullptr;
+		mCapacity	= 0;
+		mSize		= 0;
+		mGrowthLeft = 0;
+	}
+
+public:
+	[[nodiscard]] size_t Size() const
+	{
+		return mSize;
+	}
+	[[nodiscard]] size_t Capacity() const
+	{
+		return mCapacity;
+	}
+	[[nodiscard]] bool Empty() const
+	{
+		return mSize == 0;
+	}
+	Iterator begin() const
+	{
+		return Iterator{this, 0};
+	}
+	Iterator end() const
+	{
+		return Iterator{this, mCapacity};
+	}
+
+private:
+	static BC_INLINE size_t Hash(const TKey& Key)
+	{
+		// Mixes weak hashes (identity for integers on most standard libraries) so both H1 and H2 get good bits.
+		const uint64_t lHash = static_cast<uint64_t>(THash{}(Key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(lHash ^ (lHash >> 32));
+	}
+	static BC_INLINE size_t H1(const size_t Hash)
+	{
+		return Hash >> 7;
+	}
+	static BC_INLINE int8_t H2(const size_t Hash)
+	{
+		return static_cast<int8_t>(Hash & 0x7F);
+	}
+	static BC_INLINE size_t MaxLoad(const size_t Capacity)
+	{
+		return Capacity - Capacity / 8;
+	}
+
+	size_t FindIndex(const TKey& Key) const
+	{
+		if (!mCapacity)
+			return NOT_FOUND;
+		const size_t lHash	= Hash(Key);
+		const int8_t lH2	= H2(lHash);
+		const size_t lMask	= mCapacity / GROUP_SIZE - 1;
+		size_t		 lGroup = H1(lHash) & lMask;
+		for (size_t lStep = 1;; ++lStep)
+		{
+			const Group lCtrl{mCtrl + lGroup * GROUP_SIZE};
+			for (uint64_t lMatch = lCtrl.Match(lH2); lMatch; lMatch &= lMatch - 1)
+			{
+				const size_t lIndex = lGroup * GROUP_SIZE + (FindFirstSet(lMatch) >> GROUP_SHIFT);
+				if (mEntries[lIndex].Key == Key)
+					return lIndex;
+			}
+			if (lCtrl.MatchEmpty() || lStep > lMask)
+				return NOT_FOUND;
+			lGroup = (lGroup + lStep) & lMask;
+		}
+	}
+
+	size_t FindInsertSlot(const size_t Hash) const
+	{
+		const size_t lMask	= mCapacity / GROUP_SIZE - 1;
+		size_t		 lGroup = H1(Hash) & lMask;
+		for (size_t lStep = 1;; ++lStep)
+		{
+			const uint64_t lNonFull = Group{mCtrl + lGroup * GROUP_SIZE}.MatchNonFull();
+			if (lNonFull)
+				return lGroup * GROUP_SIZE + (FindFirstSet(lNonFull) >> GROUP_SHIFT);
+			lGroup = (lGroup + lStep) & lMask;
+		}
+	}
+
+	bool Rehash(size_t Capacity)
+	{
+		if (Capacity < GROUP_SIZE)
+			Capacity = GROUP_SIZE;
+		const size_t	  lEntriesOffset = RoundToAligned(Capacity, alignof(Entry));
+		const size_t	  lAlignment	 = alignof(Entry) > GROUP_SIZE ? alignof(Entry) : GROUP_SIZE;
+		const MemoryBlock lData			 = mAllocator.Allocate(lEntriesOffset + sizeof(Entry) * Capacity, lAlignment);
+		if (!lData.Ptr)
+			return false;
+
+		MemoryBlock	 lOldData	  = mData;
+		int8_t*		 lOldCtrl	  = mCtrl;
+		Entry*		 lOldEntries  = mEntries;
+		const size_t lOldCapacity = mCapacity;
+
+		mData	  = lData;
+		mCtrl	  = reinterpret_cast<int8_t*>(lData.Ptr);
+		mEntries  = reinterpret_cast<Entry*>(lData.Ptr + lEntriesOffset);
+		mCapacity = Capacity;
+		BC_MEMSET(mCtrl, static_cast<uint8_t>(CTRL_EMPTY), mCapacity);
+		mGrowthLeft = MaxLoad(mCapacity) - mSize;
+
+		for (size_t lIndex = 0; lIndex < lOldCapacity; ++lIndex)
+		{
+			if (lOldCtrl[lIndex] < 0)
+				continue;
+			Entry&		 lEntry = lOldEntries[lIndex];
+			const size_t lHash	= Hash(lEntry.Key);
+			const size_t lSlot	= FindInsertSlot(lHash);
+			mCtrl[lSlot]		= H2(lHash);
+			new (mEntries + lSlot) Entry{std::move(lEntry)};
+			lEntry.~Entry();
+		}
+		if (lOldData.Ptr)
+			mAllocator.Deallocate(lOldData);
+		return true;
+	}
+
+	void Release()
+	{
+		if (!mData.Ptr)
+			return;
+		Clear();
+		mAllocator.Deallocate(mData);
+		Abandon();
+	}
+};
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_INLINE_STRING_H
+#define BC_INLINE_STRING_H
+
+#include "SmallVector.h"
+
+#include <string_view>
+
+/**
+ * @brief Null terminated string keeping up to N characters inline.
+ *
+ * Thin layer over SmallVector<char, N + 1, TAllocator>, longer strings spill to TAllocator.
+ *
+ */
+template<size_t N, typename TAllocator = Mallocator>
+class InlineString
+{
+	SmallVector<char, N + 1, TAllocator> mChars{};
+
+public:
+	InlineString()
+	{
+		mChars.PushBack('\0');
+	}
+
+	InlineString(const std::string_view Value) : InlineString()
+	{
+		Append(Value);
+	}
+
+	InlineString(const char* Value) : InlineString(std::string_view{Value})
+	{
+	}
+
+	InlineString(const InlineString&) = default;
+
+	// The moved-from string gets its terminator back so it stays a valid empty string.
+	InlineString(InlineString&& Other) noexcept : mChars{std::move(Other.mChars)}
+	{
+		Other.mChars.PushBack('\0');
+	}
+
+	InlineString& operator=(const InlineString&) = default;
+
+	InlineString& operator=(InlineString&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			mChars = std::move(Other.mChars);
+			Other.mChars.PushBack('\0');
+		}
+		return *this;
+	}
+
+public:
+	InlineString& Append(const std::string_view Value)
+	{
+		mChars.PopBack();
+		mChars.Append(Value.data(), Value.data() + Value.size());
+		mChars.PushBack('\0');
+		return *this;
+	}
+
+	InlineString& Append(const char Value)
+	{
+		mChars.Back() = Value;
+		mChars.PushBack('\0');
+		return *this;
+	}
+
+	InlineString& operator+=(const std::string_view Value)
+	{
+		return Append(Value);
+	}
+
+	InlineString& operator+=(const char Value)
+	{
+		return Append(Value);
+	}
+
+	void Clear()
+	{
+		mChars.Clear();
+		mChars.PushBack('\0');
+	}
+
+public:
+	[[nodiscard]] size_t Size() const
+	{
+		return mChars.Size() - 1;
+	}
+	[[nodiscard]] bool Empty() const
+	{
+		return Size() == 0;
+	}
+	[[nodiscard]] bool IsInline() const
+	{
+		return mChars.IsInline();
+	}
+	BC_INLINE const char* CStr() const
+	{
+		return mChars.Data();
+	}
+	BC_INLINE std::string_view View() const
+	{
+		return std::string_view{mChars.Data(), Size()};
+	}
+	BC_INLINE operator std::string_view() const
+	{
+		return View();
+	}
+	BC_INLINE char& operator[](const size_t Index)
+	{
+		assert(Index < Size() && "Out of bounds.");
+		return mChars[Index];
+	}
+	BC_INLINE char operator[](const size_t Index) const
+	{
+		assert(Index < Size() && "Out of bounds.");
+		return mChars[Index];
+	}
+	BC_INLINE const char* begin() const
+	{
+		return mChars.begin();
+	}
+	BC_INLINE const char* end() const
+	{
+		return mChars.begin() + Size();
+	}
+	BC_INLINE bool operator==(const std::string_view Other) const
+	{
+		return View() == Other;
+	}
+	BC_INLINE bool operator!=(const std::string_view Other) const
+	{
+		return View() != Other;
+	}
+};
+
+#endif
@@ -28,4 +28,7 @@
 
 #define UNUSED(X) (void)X
 
+#define BC_CONCAT_IMPL(A, B) A##B
+#define BC_CONCAT(A, B)		 BC_CONCAT_IMPL(A, B)
+
 #endif
@@ -0,0 +1,455 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_MAPPED_ARENA_H
+#define BC_MAPPED_ARENA_H
+
+#include "Allocator.h"
+
+#if _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+RESULT_DEFINE(ErrorFileOpen, "ErrorFileOpen", "Error file open. Indicates that a file couldn't be opened or resized.",
+			  "Failed. The file couldn't be opened or resized.");
+RESULT_DEFINE(ErrorFileMap, "ErrorFileMap", "Error file map. Indicates that a file couldn't be mapped into memory.",
+			  "Failed. The file couldn't be mapped into memory.");
+RESULT_DEFINE(ErrorInvalidFormat, "ErrorInvalidFormat",
+			  "Error invalid format. Indicates that data doesn't have the layout or version expected by its reader.",
+			  "Failed. Invalid data format or version.");
+
+/**
+ * @brief Self-relative pointer.
+ *
+ * Stores the distance from its own address to the target instead of the target address, so a graph of objects linked
+ * by OffsetPtr stays valid when the memory holding it is mapped at another address, in another process or after a
+ * round trip through a file. A zero offset is null. Copying rebases the offset to the new location.
+ *
+ */
+template<typename T>
+class OffsetPtr
+{
+	int64_t mOffset{};
+
+public:
+	OffsetPtr() = default;
+	OffsetPtr(T* Ptr)
+	{
+		Set(Ptr);
+	}
+	OffsetPtr(const OffsetPtr& Other)
+	{
+		Set(Other.Get());
+	}
+	OffsetPtr& operator=(const OffsetPtr& Other)
+	{
+		Set(Other.Get());
+		return *this;
+	}
+	OffsetPtr& operator=(T* Ptr)
+	{
+		Set(Ptr);
+		return *this;
+	}
+
+public:
+	BC_INLINE void Set(T* Ptr)
+	{
+		mOffset = Ptr ? static_cast<int64_t>(reinterpret_cast<uintptr_t>(Ptr) - reinterpret_cast<uintptr_t>(this)) : 0;
+	}
+	BC_INLINE T* Get() const
+	{
+		return mOffset ? reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + static_cast<uintptr_t>(mOffset))
+					   : nullptr;
+	}
+	BC_INLINE T* operator->() const
+	{
+		assert(mOffset && "Invalid pointer.");
+		return Get();
+	}
+	BC_INLINE T& operator*() const
+	{
+		assert(mOffset && "Invalid pointer.");
+		return *Get();
+	}
+	BC_INLINE BC_EXPLICIT operator bool() const
+	{
+		return mOffset != 0;
+	}
+};
+
+/**
+ * @brief Array view with a self-relative data pointer, the mapped counterpart of ArrayInstance.
+ *
+ */
+template<typename T>
+struct OffsetArray
+{
+	using Type = T;
+	OffsetPtr<T> Value;
+	uint64_t	 Size{};
+	BC_INLINE T& operator[](size_t Index) const
+	{
+		assert(Value && "Invalid pointer.");
+		assert(Index < Size && "Out of bounds.");
+		return Value.Get()[Index];
+	}
+	BC_INLINE BC_EXPLICIT operator bool() const
+	{
+		return static_cast<bool>(Value);
+	}
+	BC_INLINE T* begin() const
+	{
+		return Value.Get();
+	}
+	BC_INLINE T* end() const
+	{
+		return Value.Get() + Size;
+	}
+};
+
+enum class MappedArenaMode : uint8_t
+{
+	ReadWrite,
+	ReadOnly,
+	CopyOnWrite
+};
+
+/**
+ * @brief Bump arena backed by a memory-mapped file.
+ *
+ * Create sizes a file to the requested capacity and maps it shared, everything allocated afterwards lands straight in
+ * the file. Open maps an existing arena back and makes it usable right away: read only (pages shared between
+ * processes), copy on write (private edits, file untouched) or read write. Loading costs only the page faults of the
+ * pages actually touched, there is no parsing step.
+ *
+ * The header at the start of the mapping keeps the bump cursor and one root offset, so the arena can be reopened and
+ * extended. Stored objects must be position independent: link them with OffsetPtr/OffsetArray, never with raw
+ * pointers, and avoid polymorphic types. Alignments are honored up to the page size.
+ *
+ */
+class MappedArena
+{
+	static constexpr uint64_t MAGIC	  = 0x414e455241444d42ull; // "BMDARENA"
+	static constexpr uint32_t VERSION = 1;
+
+	struct Header
+	{
+		uint64_t Magic;
+		uint32_t Version;
+		uint32_t HeaderSize;
+		uint64_t Capacity;
+		uint64_t Used;
+		uint64_t Root;
+	};
+
+	uint8_t*		mData{};
+	size_t			mSize{};
+	MappedArenaMode mMode{MappedArenaMode::ReadOnly};
+#if _WIN32
+	HANDLE mFile{INVALID_HANDLE_VALUE};
+	HANDLE mMapping{};
+#else
+	int mFile{-1};
+#endif
+
+public:
+	// Offsets are relative to the page aligned mapping, so alignments up to the smallest page size hold.
+	static constexpr size_t MAX_ALIGNMENT = 4096;
+
+public:
+	MappedArena() = default;
+	MappedArena(const MappedArena&)			   = delete;
+	MappedArena& operator=(const MappedArena&) = delete;
+	MappedArena(MappedArena&& Other) noexcept
+	{
+		*this = std::move(Other);
+	}
+	MappedArena& operator=(MappedArena&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Close();
+			mData = std::exchange(Other.mData, nullptr);
+			mSize = std::exchange(Other.mSize, 0);
+			mMode = Other.mMode;
+#if _WIN32
+			mFile	 = std::exchange(Other.mFile, INVALID_HANDLE_VALUE);
+			mMapping = std::exchange(Other.mMapping, nullptr);
+#else
+			mFile = std::exchange(Other.mFile, -1);
+#endif
+		}
+		return *this;
+	}
+	~MappedArena()
+	{
+		Close();
+	}
+
+public:
+	/**
+	 * @brief Creates or truncates the file at Path to Capacity bytes and maps it read write as an empty arena.
+	 *
+	 * Returns ResultOk, or the error that left the arena closed.
+	 *
+	 */
+	[[nodiscard]] result_t Create(const char* Path, const size_t Capacity)
+	{
+		Close();
+		RESULT_RETURN_CHECK(Capacity < sizeof(Header), ResultErrorOutOfBounds);
+		const result_t lResult = Map(Path, Capacity, MappedArenaMode::ReadWrite);
+		RESULT_RETURN_CHECK(lResult != ResultOk, lResult);
+
+		Header* lHeader		= GetHeader();
+		lHeader->Magic		= MAGIC;
+		lHeader->Version	= VERSION;
+		lHeader->HeaderSize = static_cast<uint32_t>(RoundToAligned(sizeof(Header)));
+		lHeader->Capacity	= Capacity;
+		lHeader->Used		= lHeader->HeaderSize;
+		lHeader->Root		= 0;
+		return ResultOk;
+	}
+
+	/**
+	 * @brief Maps an arena previously written by Create and validates its header.
+	 *
+	 * Returns ResultOk, or the error that left the arena closed.
+	 *
+	 */
+	[[nodiscard]] result_t Open(const char* Path, const MappedArenaMode Mode = MappedArenaMode::ReadOnly)
+	{
+		Close();
+		const result_t lResult = Map(Path, 0, Mode);
+		RESULT_RETURN_CHECK(lResult != ResultOk, lResult);
+
+		const Header* lHeader = GetHeader();
+		const bool	  lValid  = mSize >= sizeof(Header) && lHeader->Magic == MAGIC && lHeader->Version == VERSION &&
+							lHeader->Capacity == mSize && lHeader->Used >= lHeader->HeaderSize &&
+							lHeader->Used <= mSize;
+		RESULT_RETURN_CHECK(!lValid, (Close(), ResultErrorInvalidFormat));
+		return ResultOk;
+	}
+
+	/**
+	 * @brief Writes dirty pages of a read write arena back to its file.
+	 *
+	 */
+	bool Flush()
+	{
+		if (!mData || mMode != MappedArenaMode::ReadWrite)
+			return false;
+#if _WIN32
+		return FlushViewOfFile(mData, mSize) && FlushFileBuffers(mFile);
+#else
+		return msync(mData, mSize, MS_SYNC) == 0;
+#endif
+	}
+
+	void Close()
+	{
+#if _WIN32
+		if (mData)
+			UnmapViewOfFile(mData);
+		if (mMapping)
+			CloseHandle(mMapping);
+		if (mFile != INVALID_HANDLE_VALUE)
+			CloseHandle(mFile);
+		mFile	 = INVALID_HANDLE_VALUE;
+		mMapping = nullptr;
+#else
+		if (mData)
+			munmap(mData, mSize);
+		if (mFile >= 0)
+			close(mFile);
+		mFile = -1;
+#endif
+		mData = nullptr;
+		mSize = 0;
+	}
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		assert(IsPowerOfTwo(Alignment) && Alignment <= MAX_ALIGNMENT && "Invalid alignment.");
+		if (!IsWritable())
+			return MemoryBlock{};
+		Header*		   lHeader = GetHeader();
+		const uint64_t lBegin  = RoundToAligned(lHeader->Used, Alignment);
+		if (lBegin + Size > lHeader->Capacity)
+			return MemoryBlock{};
+		lHeader->Used = lBegin + Size;
+		return MemoryBlock{mData + lBegin, Size};
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		if (IsWritable() && Mb.Ptr + Mb.Size == mData + GetHeader()->Used)
+			GetHeader()->Used = static_cast<uint64_t>(Mb.Ptr - mData);
+		Mb = {};
+	}
+
+	void DeallocateAll()
+	{
+		if (IsWritable())
+		{
+			GetHeader()->Used = GetHeader()->HeaderSize;
+			GetHeader()->Root = 0;
+		}
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return Mb.Ptr >= mData && Mb.Ptr < mData + mSize;
+	}
+
+	[[nodiscard]] MemoryBlock Region() const
+	{
+		return MemoryBlock{mData, mSize};
+	}
+
+public:
+	template<typename T, typename... TArgs>
+	T* Construct(TArgs&&... Args)
+	{
+		static_assert(!std::is_polymorphic_v<T>, "Mapped objects can't hold virtual table pointers.");
+		const MemoryBlock lMb = Allocate(sizeof(T), alignof(T));
+		return lMb.Ptr ? new (lMb.Ptr) T{std::forward<TArgs>(Args)...} : nullptr;
+	}
+
+	template<typename T, typename... TArgs>
+	OffsetArray<T> ConstructArray(const size_t Size, TArgs&&... Args)
+	{
+		static_assert(!std::is_polymorphic_v<T>, "Mapped objects can't hold virtual table pointers.");
+		const MemoryBlock lMb = Allocate(sizeof(T) * Size, alignof(T));
+		if (!lMb.Ptr)
+			return OffsetArray<T>{};
+		return OffsetArray<T>{
+			UninitializedConstruct<T*>(reinterpret_cast<T*>(lMb.Ptr), Size, std::forward<TArgs>(Args)...), Size};
+	}
+
+	/**
+	 * @brief Records Value as the arena entry point, retrieved with Root after the next Open.
+	 *
+	 */
+	template<typename T>
+	void SetRoot(const T* Value)
+	{
+		assert(IsWritable() && "Arena isn't writable.");
+		assert((!Value || Owns(MemoryBlock{reinterpret_cast<uint8_t*>(const_cast<T*>(Value)), sizeof(T)})) &&
+			   "Root needs to live in the arena.");
+		GetHeader()->Root = Value ? static_cast<uint64_t>(reinterpret_cast<const uint8_t*>(Value) - mData) : 0;
+	}
+
+	template<typename T>
+	[[nodiscard]] T* Root() const
+	{
+		return mData && GetHeader()->Root ? reinterpret_cast<T*>(mData + GetHeader()->Root) : nullptr;
+	}
+
+	[[nodiscard]] bool IsOpen() const
+	{
+		return mData != nullptr;
+	}
+	[[nodiscard]] bool IsWritable() const
+	{
+		return mData && mMode != MappedArenaMode::ReadOnly;
+	}
+	[[nodiscard]] size_t Used() const
+	{
+		return mData ? static_cast<size_t>(GetHeader()->Used) : 0;
+	}
+	[[nodiscard]] size_t Capacity() const
+	{
+		return mSize;
+	}
+
+private:
+	BC_INLINE Header* GetHeader() const
+	{
+		return reinterpret_cast<Header*>(mData);
+	}
+
+	// Opens Path and maps it whole. A non-zero Size creates or truncates the file to that size first.
+	result_t Map(const char* Path, size_t Size, const MappedArenaMode Mode)
+	{
+		const bool lWrite = Mode == MappedArenaMode::ReadWrite;
+#if _WIN32
+		mFile = CreateFileA(Path, lWrite ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+							Size ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		RESULT_RETURN_CHECK(mFile == INVALID_HANDLE_VALUE, ResultErrorFileOpen);
+		if (!Size)
+		{
+			LARGE_INTEGER lFileSize{};
+			GetFileSizeEx(mFile, &lFileSize);
+			Size = static_cast<size_t>(lFileSize.QuadPart);
+		}
+		RESULT_RETURN_CHECK(!Size, (Close(), ResultErrorInvalidFormat));
+
+		const DWORD lProtect = lWrite ? PAGE_READWRITE : Mode == MappedArenaMode::CopyOnWrite ? PAGE_WRITECOPY
+																							   : PAGE_READONLY;
+		const DWORD lAccess	 = lWrite ? FILE_MAP_WRITE : Mode == MappedArenaMode::CopyOnWrite ? FILE_MAP_COPY
+																							   : FILE_MAP_READ;
+		mMapping = CreateFileMappingA(mFile, nullptr, lProtect, static_cast<DWORD>(uint64_t(Size) >> 32),
+									  static_cast<DWORD>(Size), nullptr);
+		RESULT_RETURN_CHECK(!mMapping, (Close(), ResultErrorFileMap));
+		void* lData = MapViewOfFile(mMapping, lAccess, 0, 0, Size);
+		RESULT_RETURN_CHECK(!lData, (Close(), ResultErrorFileMap));
+#else
+		mFile = open(Path, lWrite ? O_RDWR | (Size ? O_CREAT | O_TRUNC : 0) : O_RDONLY, 0644);
+		RESULT_RETURN_CHECK(mFile < 0, ResultErrorFileOpen);
+		if (Size)
+		{
+			RESULT_RETURN_CHECK(ftruncate(mFile, static_cast<off_t>(Size)) != 0, (Close(), ResultErrorFileOpen));
+		}
+		else
+		{
+			struct stat lStat{};
+			fstat(mFile, &lStat);
+			Size = static_cast<size_t>(lStat.st_size);
+		}
+		RESULT_RETURN_CHECK(!Size, (Close(), ResultErrorInvalidFormat));
+
+		const int lProtect = Mode == MappedArenaMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+		const int lFlags   = Mode == MappedArenaMode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED;
+		void*	  lData	   = mmap(nullptr, Size, lProtect, lFlags, mFile, 0);
+		RESULT_RETURN_CHECK(lData == MAP_FAILED, (Close(), ResultErrorFileMap));
+#endif
+		mData = static_cast<uint8_t*>(lData);
+		mSize = Size;
+		mMode = Mode;
+		return ResultOk;
+	}
+};
+
+#endif
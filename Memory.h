@@ -30,8 +30,17 @@
 
 #include <type_traits>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#if BC_LANGUAGE_VERSION >= BC_LANGUAGE_CPP20
+#include <memory>
+#endif
 
-#define BC_ALIGN_MEMORY_SIZE(SIZE, ALIGNMENT) (SIZE + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1)
+#define BC_ALIGN_MEMORY_SIZE(SIZE, ALIGNMENT) (((SIZE) + ((ALIGNMENT)-1)) & ~((ALIGNMENT)-1))
 
 #ifndef BC_ALLOCATION_FUNCTIONS
 #define BC_ALLOCATION_FUNCTIONS
@@ -40,8 +49,8 @@
 #define BC_MALLOC_ALIGNED(N, ALIGNMENT) _aligned_malloc(N, ALIGNMENT)
 #define BC_FREE(BLOCK, N)				_aligned_free(BLOCK)
 #elif __linux__
-#define BC_MALLOC(N)					aligned_alloc(N, BC_PLATFORM_ALIGNMENT)
-#define BC_MALLOC_ALIGNED(N, ALIGNMENT) aligned_alloc(N, ALIGNMENT)
+#define BC_MALLOC(N)					BC_MALLOC_ALIGNED(N, BC_PLATFORM_ALIGNMENT)
+#define BC_MALLOC_ALIGNED(N, ALIGNMENT) aligned_alloc(ALIGNMENT, BC_ALIGN_MEMORY_SIZE(N, ALIGNMENT))
 #define BC_FREE(BLOCK, N)				free(BLOCK)
 #endif
 #endif
@@ -52,30 +61,83 @@
 #define BC_MEMCHR(PTR, VALUE, N) memchr(STR, VALUE, N)
 #define BC_MEMCMP(A, B, N)		 memcmp(A, B, N)
 #define BC_MEMCPY(DST, SRC, N)	 memcpy(DST, SRC, N)
-#define BC_MEMMOVE(DST, SRC, N)	 memcpy(DST, SRC, N)
+#define BC_MEMMOVE(DST, SRC, N)	 memmove(DST, SRC, N)
 #define BC_MEMSET(PTR, VALUE, N) memset(PTR, VALUE, N)
 #define BC_MEMZERO(PTR, N)		 BC_MEMSET(PTR, 0, N)
 #elif __linux__
 #define BC_MEMCHR(PTR, VALUE, N) memchr(STR, VALUE, N)
 #define BC_MEMCMP(A, B, N)		 memcmp(A, B, N)
 #define BC_MEMCPY(DST, SRC, N)	 memcpy(DST, SRC, N)
-#define BC_MEMMOVE(DST, SRC, N)	 memcpy(DST, SRC, N)
+#define BC_MEMMOVE(DST, SRC, N)	 memmove(DST, SRC, N)
 #define BC_MEMSET(PTR, VALUE, N) memset(PTR, VALUE, N)
 #define BC_MEMZERO(PTR, N)		 BC_MEMSET(PTR, 0, N)
 #endif
 #endif
 
+#if !_WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Size of a virtual memory page, queried once from the OS.
+ *
+ */
+BC_INLINE size_t VirtualPageSize()
+{
+	static const size_t lPageSize = []
+	{
+#if _WIN32
+		SYSTEM_INFO lInfo{};
+		GetSystemInfo(&lInfo);
+		return static_cast<size_t>(lInfo.dwPageSize);
+#else
+		const long lSize = sysconf(_SC_PAGESIZE);
+		return lSize > 0 ? static_cast<size_t>(lSize) : size_t{4096};
+#endif
+	}();
+	return lPageSize;
+}
+
+/**
+ * @brief Hands the physical pages lying entirely inside [Ptr, Ptr + Size) back to the OS.
+ *
+ * The range stays mapped and usable, its content is undefined afterwards and pages fault back in on the next touch.
+ * Uses MADV_DONTNEED, which drops resident size right away, or the lazier MADV_FREE when BC_VIRTUAL_DECOMMIT_LAZY is
+ * defined, and MEM_RESET on Windows. Returns the number of bytes released.
+ *
+ */
+BC_INLINE size_t VirtualDecommit(void* Ptr, const size_t Size)
+{
+	const uintptr_t lPageMask = VirtualPageSize() - 1;
+	const uintptr_t lBegin	  = (reinterpret_cast<uintptr_t>(Ptr) + lPageMask) & ~lPageMask;
+	const uintptr_t lEnd	  = (reinterpret_cast<uintptr_t>(Ptr) + Size) & ~lPageMask;
+	if (lBegin >= lEnd)
+		return 0;
+	void* const	 lPtr  = reinterpret_cast<void*>(lBegin);
+	const size_t lSize = lEnd - lBegin;
+#if _WIN32
+	return VirtualAlloc(lPtr, lSize, MEM_RESET, PAGE_READWRITE) ? lSize : 0;
+#else
+#if defined(BC_VIRTUAL_DECOMMIT_LAZY) && defined(MADV_FREE)
+	if (madvise(lPtr, lSize, MADV_FREE) == 0)
+		return lSize;
+#endif
+	return madvise(lPtr, lSize, MADV_DONTNEED) == 0 ? lSize : 0;
+#endif
+}
+
 template<typename T>
 struct Instance
 {
 	using Type = T;
-	T*			 Value{};
-	BC_INLINE T* operator->() const
+	T*					   Value{};
+	BC_INLINE constexpr T* operator->() const
 	{
 		assert(Value && "Invalid pointer.");
 		return Value;
 	}
-	BC_INLINE BC_EXPLICIT operator bool() const
+	BC_INLINE constexpr BC_EXPLICIT operator bool() const
 	{
 		return Value != nullptr;
 	}
@@ -85,28 +147,42 @@ template<typename T>
 struct ArrayInstance
 {
 	using Type = T;
-	T*			 Value;
-	size_t		 Size{};
-	BC_INLINE T& operator[](size_t Index) const
+	T*					   Value{};
+	size_t				   Size{};
+	BC_INLINE constexpr T& operator[](size_t Index) const
 	{
 		assert(Value && "Invalid pointer.");
 		assert(Index < Size && "Out of bounds.");
 		return Value[Index];
 	}
-	BC_INLINE BC_EXPLICIT operator bool() const
+	BC_INLINE constexpr BC_EXPLICIT operator bool() const
 	{
 		return Value != nullptr;
 	}
-	BC_INLINE const T* begin() const
+	BC_INLINE constexpr const T* begin() const
 	{
 		return Value;
 	}
-	BC_INLINE const T* end() const
+	BC_INLINE constexpr const T* end() const
 	{
 		return Value + Size;
 	}
 };
 
+/**
+ * @brief Placement new of T{Args...}, also valid in C++20 constant evaluation where it goes through std::construct_at.
+ *
+ */
+template<typename T, typename... TArgs>
+BC_INLINE BC_CONSTEXPR20 T* ConstructAt(T* Ptr, TArgs&&... Args)
+{
+#if BC_LANGUAGE_VERSION >= BC_LANGUAGE_CPP20
+	if (BC_IS_CONSTANT_EVALUATED())
+		return std::construct_at(Ptr, T{std::forward<TArgs>(Args)...});
+#endif
+	return new (Ptr) T{std::forward<TArgs>(Args)...};
+}
+
 template<typename TIterator>
 BC_INLINE TIterator UninitializedCopyFill(TIterator Begin, TIterator End, std::remove_pointer_t<TIterator> Value)
 {
@@ -119,37 +195,88 @@ BC_INLINE TIterator UninitializedCopyFill(TIterator Begin, TIterator End, std::r
 }
 
 template<typename TIterator, typename... TArgs>
-BC_INLINE TIterator UninitializedConstruct(TIterator Begin, TIterator End, TArgs&&... Args)
+BC_INLINE BC_CONSTEXPR20 TIterator UninitializedConstruct(TIterator Begin, TIterator End, TArgs&&... Args)
 {
 	using Type = std::remove_pointer_t<TIterator>;
 	static_assert(std::is_pointer_v<TIterator>, "Invalid iterator type.");
 	static_assert(std::is_move_assignable_v<Type>, "Type is not move assignable.");
+	if constexpr (sizeof...(TArgs) == 0 && std::is_trivially_default_constructible_v<Type>)
+	{
+		if (!BC_IS_CONSTANT_EVALUATED())
+		{
+			BC_MEMZERO(Begin, sizeof(Type) * (End - Begin));
+			return Begin;
+		}
+	}
 	auto lData = Begin;
 	while (lData < End)
-		new (lData++) Type{std::forward<TArgs>(Args)...};
+		ConstructAt(lData++, std::forward<TArgs>(Args)...);
 	return Begin;
 }
 
 template<typename TIterator, typename... TArgs>
-BC_INLINE TIterator UninitializedConstruct(const TIterator Begin, const size_t Size, TArgs&&... Args)
+BC_INLINE BC_CONSTEXPR20 TIterator UninitializedConstruct(const TIterator Begin, const size_t Size, TArgs&&... Args)
 {
 	return UninitializedConstruct<TIterator, TArgs...>(Begin, Begin + Size, std::forward<TArgs>(Args)...);
 }
 
+template<typename TInputIterator, typename TIterator>
+BC_INLINE TIterator UninitializedCopy(TInputIterator Begin, TInputIterator End, TIterator Destination)
+{
+	using Type = std::remove_pointer_t<TIterator>;
+	static_assert(std::is_pointer_v<TIterator> && std::is_pointer_v<TInputIterator>, "Invalid iterator type.");
+	static_assert(std::is_copy_constructible_v<Type>, "Type is not copy constructible.");
+	if constexpr (std::is_trivially_copyable_v<Type>)
+	{
+		if (Begin != End)
+			BC_MEMCPY(Destination, Begin, sizeof(Type) * (End - Begin));
+	}
+	else
+	{
+		auto lData = Destination;
+		while (Begin < End)
+			new (lData++) Type(*(Begin++));
+	}
+	return Destination;
+}
+
+template<typename TIterator>
+BC_INLINE TIterator UninitializedMove(TIterator Begin, TIterator End, TIterator Destination)
+{
+	using Type = std::remove_pointer_t<TIterator>;
+	static_assert(std::is_pointer_v<TIterator>, "Invalid iterator type.");
+	static_assert(std::is_move_constructible_v<Type>, "Type is not move constructible.");
+	if constexpr (std::is_trivially_copyable_v<Type>)
+	{
+		if (Begin != End)
+			BC_MEMMOVE(Destination, Begin, sizeof(Type) * (End - Begin));
+	}
+	else
+	{
+		auto lData = Destination;
+		while (Begin < End)
+			new (lData++) Type(std::move(*(Begin++)));
+	}
+	return Destination;
+}
+
 template<typename TIterator, typename... TArgs>
-BC_INLINE TIterator Destruct(TIterator Begin, TIterator End)
+BC_INLINE BC_CONSTEXPR20 TIterator Destruct(TIterator Begin, TIterator End)
 {
 	using Type = std::remove_pointer_t<TIterator>;
 	static_assert(std::is_pointer_v<TIterator>, "Invalid iterator type.");
 	static_assert(std::is_move_assignable_v<Type>, "Type is not move assignable.");
-	auto lData = Begin;
-	while (lData < End)
-		(lData++)->~Type();
+	if constexpr (!std::is_trivially_destructible_v<Type>)
+	{
+		auto lData = Begin;
+		while (lData < End)
+			(lData++)->~Type();
+	}
 	return Begin;
 }
 
 template<typename TIterator, typename... TArgs>
-BC_INLINE TIterator Destruct(TIterator Begin, const size_t Size)
+BC_INLINE BC_CONSTEXPR20 TIterator Destruct(TIterator Begin, const size_t Size)
 {
 	return Destruct<TIterator>(Begin, Begin + Size);
 }
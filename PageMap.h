@@ -0,0 +1,289 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_PAGE_MAP_H
+#define BC_PAGE_MAP_H
+
+#include "Allocator.h"
+
+#include <tuple>
+#include <utility>
+
+/**
+ * @brief Two level radix map from any address to a small per page value.
+ *
+ * Covers a 48-bit address space in pages of 1 << PageShift bytes. Get costs two dependent loads (root slot then leaf
+ * value) and returns a zero TValue for pages that were never set. Root and leaves come from TSupportAllocator on the
+ * first Set touching them, so lookups never allocate.
+ *
+ */
+template<typename TValue = uint16_t, size_t PageShift = 16, typename TSupportAllocator = Mallocator>
+class PageMap
+{
+	static constexpr size_t ADDRESS_BITS = 48;
+	static constexpr size_t PAGE_BITS	 = ADDRESS_BITS - PageShift;
+	static constexpr size_t LEAF_BITS	 = (PAGE_BITS + 1) / 2;
+	static constexpr size_t ROOT_BITS	 = PAGE_BITS - LEAF_BITS;
+	static constexpr size_t LEAF_COUNT	 = size_t{1} << LEAF_BITS;
+	static constexpr size_t ROOT_COUNT	 = size_t{1} << ROOT_BITS;
+
+	static_assert(std::is_trivially_copyable_v<TValue>, "PageMap values need to be trivially copyable.");
+
+	struct Leaf
+	{
+		TValue Values[LEAF_COUNT];
+	};
+
+	TSupportAllocator mAllocator{};
+	Leaf**			  mRoot{};
+
+public:
+	static constexpr size_t PAGE_SIZE = size_t{1} << PageShift;
+
+public:
+	PageMap() = default;
+
+	~PageMap()
+	{
+		if (!mRoot)
+			return;
+		for (size_t lIndex = 0; lIndex < ROOT_COUNT; ++lIndex)
+		{
+			if (!mRoot[lIndex])
+				continue;
+			MemoryBlock lLeaf{reinterpret_cast<uint8_t*>(mRoot[lIndex]), sizeof(Leaf)};
+			mAllocator.Deallocate(lLeaf);
+		}
+		MemoryBlock lRoot{reinterpret_cast<uint8_t*>(mRoot), sizeof(Leaf*) * ROOT_COUNT};
+		mAllocator.Deallocate(lRoot);
+	}
+
+	PageMap(const PageMap&)			   = delete;
+	PageMap& operator=(const PageMap&) = delete;
+
+public:
+	/**
+	 * @brief Sets Value for every page overlapping [Begin, End). Returns false when a node could not be allocated.
+	 *
+	 */
+	bool Set(const void* Begin, const void* End, const TValue Value)
+	{
+		if (Begin >= End)
+			return true;
+		const uintptr_t lFirst = PageOf(Begin);
+		const uintptr_t lLast  = PageOf(static_cast<const uint8_t*>(End) - 1);
+		for (uintptr_t lPage = lFirst; lPage <= lLast; ++lPage)
+		{
+			Leaf* lLeaf = EnsureLeaf(lPage >> LEAF_BITS);
+			if (!lLeaf)
+				return false;
+			lLeaf->Values[lPage & (LEAF_COUNT - 1)] = Value;
+		}
+		return true;
+	}
+
+	BC_INLINE TValue Get(const void* Ptr) const
+	{
+		const uintptr_t lPage = PageOf(Ptr);
+		const Leaf*		lLeaf = mRoot ? mRoot[lPage >> LEAF_BITS] : nullptr;
+		return lLeaf ? lLeaf->Values[lPage & (LEAF_COUNT - 1)] : TValue{};
+	}
+
+private:
+	static BC_INLINE uintptr_t PageOf(const void* Ptr)
+	{
+		const uintptr_t lAddress = reinterpret_cast<uintptr_t>(Ptr);
+		assert((lAddress >> ADDRESS_BITS) == 0 && "Address outside of the PageMap range.");
+		return lAddress >> PageShift;
+	}
+
+	Leaf* EnsureLeaf(const size_t Index)
+	{
+		if (!mRoot)
+		{
+			const MemoryBlock lRoot = mAllocator.Allocate(sizeof(Leaf*) * ROOT_COUNT, alignof(Leaf*));
+			if (!lRoot.Ptr)
+				return nullptr;
+			BC_MEMZERO(lRoot.Ptr, sizeof(Leaf*) * ROOT_COUNT);
+			mRoot = reinterpret_cast<Leaf**>(lRoot.Ptr);
+		}
+		if (!mRoot[Index])
+		{
+			const MemoryBlock lLeaf = mAllocator.Allocate(sizeof(Leaf), alignof(Leaf));
+			if (!lLeaf.Ptr)
+				return nullptr;
+			BC_MEMZERO(lLeaf.Ptr, sizeof(Leaf));
+			mRoot[Index] = reinterpret_cast<Leaf*>(lLeaf.Ptr);
+		}
+		return mRoot[Index];
+	}
+};
+
+template<typename T, typename = void>
+struct AllocatorHasRegion: std::false_type
+{
+};
+
+template<typename T>
+struct AllocatorHasRegion<T, std::void_t<decltype(std::declval<const T&>().Region())>>: std::true_type
+{
+};
+
+/**
+ * @brief Variadic FallbackAllocator that finds the owner of a block through a PageMap.
+ *
+ * Allocate tries the tiers in order like FallbackAllocator. Tiers exposing a fixed Region() (StackAllocator,
+ * PoolAllocator, TlsfAllocator) have the pages they fully cover tagged with their index at construction, so
+ * Deallocate and Owns reach the right tier with one PageMap lookup whatever the tier order. Pages outside every region
+ * go straight to the remaining tiers (typically a final Mallocator), and only the few pages a region partially covers
+ * still probe Owns.
+ *
+ */
+template<typename... TAllocators>
+class IndexedFallbackAllocator
+{
+	static_assert(sizeof...(TAllocators) > 0 && sizeof...(TAllocators) < 255, "Invalid number of tiers.");
+
+	static constexpr uint8_t PAGE_UNINDEXED = 0;
+	static constexpr uint8_t PAGE_SHARED	= 0xFF;
+
+	using indices_t = std::index_sequence_for<TAllocators...>;
+
+	std::tuple<TAllocators...> mTiers{};
+	PageMap<uint8_t>		   mPageMap{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = std::min({AllocatorMaxAlignment<TAllocators>::value...});
+
+public:
+	IndexedFallbackAllocator()
+	{
+		IndexRegions(indices_t{});
+	}
+
+	IndexedFallbackAllocator(const IndexedFallbackAllocator&)			 = delete;
+	IndexedFallbackAllocator& operator=(const IndexedFallbackAllocator&) = delete;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		BC_PROFILE_SCOPE("IndexedFallbackAllocator::Allocate");
+		return AllocateFrom(Size, Alignment, indices_t{});
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		BC_PROFILE_SCOPE("IndexedFallbackAllocator::Deallocate");
+		if (!Mb.Ptr)
+			return;
+		const uint8_t lPage = mPageMap.Get(Mb.Ptr);
+		if (lPage != PAGE_UNINDEXED && lPage != PAGE_SHARED)
+			DeallocateTier(lPage - 1, Mb, indices_t{});
+		else if (lPage == PAGE_UNINDEXED || !DeallocateProbing<true>(Mb, indices_t{}))
+			DeallocateProbing<false>(Mb, indices_t{});
+		Mb = {};
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		const uint8_t lPage = mPageMap.Get(Mb.Ptr);
+		if (lPage != PAGE_UNINDEXED && lPage != PAGE_SHARED)
+			return true;
+		return (lPage == PAGE_SHARED && OwnsProbing<true>(Mb, indices_t{})) || OwnsProbing<false>(Mb, indices_t{});
+	}
+
+	template<size_t Index>
+	auto& Tier()
+	{
+		return std::get<Index>(mTiers);
+	}
+
+private:
+	template<size_t... Indices>
+	void IndexRegions(std::index_sequence<Indices...>)
+	{
+		(IndexRegion<Indices>(), ...);
+	}
+
+	template<size_t Index>
+	void IndexRegion()
+	{
+		using tier_t = std::tuple_element_t<Index, std::tuple<TAllocators...>>;
+		if constexpr (AllocatorHasRegion<tier_t>::value)
+		{
+			constexpr size_t  lPageSize = PageMap<uint8_t>::PAGE_SIZE;
+			const MemoryBlock lRegion	= std::get<Index>(mTiers).Region();
+			if (!lRegion.Ptr)
+				return;
+			uint8_t* lBegin = lRegion.Ptr;
+			uint8_t* lEnd	= lRegion.Ptr + lRegion.Size;
+			uint8_t* lInnerBegin =
+				reinterpret_cast<uint8_t*>(RoundToAligned(reinterpret_cast<uintptr_t>(lBegin), lPageSize));
+			uint8_t* lInnerEnd = reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(lEnd) & ~(lPageSize - 1));
+			if (lInnerBegin >= lInnerEnd)
+				lInnerBegin = lInnerEnd = lBegin;
+			bool lIndexed = mPageMap.Set(lInnerBegin, lInnerEnd, static_cast<uint8_t>(Index + 1));
+			lIndexed &= mPageMap.Set(lBegin, lInnerBegin, PAGE_SHARED);
+			lIndexed &= mPageMap.Set(lInnerEnd, lEnd, PAGE_SHARED);
+			assert(lIndexed && "PageMap allocation failed.");
+			UNUSED(lIndexed);
+		}
+	}
+
+	template<size_t... Indices>
+	MemoryBlock AllocateFrom(size_t Size, size_t Alignment, std::index_sequence<Indices...>)
+	{
+		MemoryBlock lMemoryBlock{};
+		((lMemoryBlock = std::get<Indices>(mTiers).Allocate(Size, Alignment)).Ptr || ...);
+		return lMemoryBlock;
+	}
+
+	template<size_t... Indices>
+	void DeallocateTier(const size_t Tier, MemoryBlock& Mb, std::index_sequence<Indices...>)
+	{
+		((Tier == Indices && (std::get<Indices>(mTiers).Deallocate(Mb), true)) || ...);
+	}
+
+	template<size_t Index>
+	static constexpr bool TIER_HAS_REGION =
+		AllocatorHasRegion<std::tuple_element_t<Index, std::tuple<TAllocators...>>>::value;
+
+	// Probes in order the tiers with (Indexed) or without a Region(), like FallbackAllocator does.
+	template<bool Indexed, size_t... Indices>
+	bool DeallocateProbing(MemoryBlock& Mb, std::index_sequence<Indices...>)
+	{
+		return ((TIER_HAS_REGION<Indices> == Indexed && std::get<Indices>(mTiers).Owns(Mb) &&
+				 (std::get<Indices>(mTiers).Deallocate(Mb), true)) ||
+				...);
+	}
+
+	template<bool Indexed, size_t... Indices>
+	bool OwnsProbing(MemoryBlock Mb, std::index_sequence<Indices...>) const
+	{
+		return ((TIER_HAS_REGION<Indices> == Indexed && std::get<Indices>(mTiers).Owns(Mb)) || ...);
+	}
+};
+
+#endif
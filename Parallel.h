@@ -0,0 +1,296 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_PARALLEL_H
+#define BC_PARALLEL_H
+
+#include "Memory.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Ranges smaller than this are processed on the calling thread, waking workers costs more than it saves.
+#ifndef BC_PARALLEL_MIN_BYTES
+#define BC_PARALLEL_MIN_BYTES (4ull * 1024 * 1024)
+#endif
+
+/**
+ * @brief Fixed set of worker threads running index based jobs, the calling thread takes part in every job.
+ *
+ * Run hands out the indices of a job one at a time through an atomic counter and returns once all of them ran.
+ * Jobs are serialized, a Run issued while another one is in progress waits for it. A Run issued from inside a job of
+ * the same pool would wait on itself, so it runs its indices inline on the calling thread instead.
+ *
+ */
+class WorkerPool
+{
+	using job_t = void (*)(void* Context, size_t Index);
+
+	std::mutex				mRunMutex;
+	std::mutex				mMutex;
+	std::condition_variable mWorkCondition;
+	std::condition_variable mDoneCondition;
+	job_t					mJob{};
+	void*					mContext{};
+	size_t					mCount{};
+	uint64_t				mGeneration{};
+	std::atomic<size_t>		mNext{};
+	std::atomic<size_t>		mDone{};
+	size_t					mActive{};
+	bool					mStop{};
+	std::thread*			mWorkers{};
+	size_t					mWorkerCount{};
+
+public:
+	BC_EXPLICIT WorkerPool(const size_t WorkerCount) : mWorkerCount{WorkerCount}
+	{
+		if (!mWorkerCount)
+			return;
+		mWorkers = new std::thread[mWorkerCount];
+		for (size_t lIndex = 0; lIndex < mWorkerCount; ++lIndex)
+			mWorkers[lIndex] = std::thread{&WorkerPool::WorkerMain, this};
+	}
+
+	~WorkerPool()
+	{
+		if (!mWorkers)
+			return;
+		{
+			std::lock_guard<std::mutex> lLock{mMutex};
+			mStop = true;
+		}
+		mWorkCondition.notify_all();
+		for (size_t lIndex = 0; lIndex < mWorkerCount; ++lIndex)
+			mWorkers[lIndex].join();
+		delete[] mWorkers;
+	}
+
+	WorkerPool(const WorkerPool&)			 = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+public:
+	/**
+	 * @brief Calls Job(Context, Index) for every Index in [0, Count) across the workers and the calling thread.
+	 *
+	 */
+	void Run(const size_t Count, const job_t Job, void* Context)
+	{
+		if (!Count)
+			return;
+		if (!mWorkerCount || Count == 1 || CurrentPool() == this)
+		{
+			for (size_t lIndex = 0; lIndex < Count; ++lIndex)
+				Job(Context, lIndex);
+			return;
+		}
+		std::lock_guard<std::mutex>	 lRunLock{mRunMutex};
+		std::unique_lock<std::mutex> lLock{mMutex};
+		// A worker waking up late may still hold the previous job, the counters are only reset once it left.
+		mDoneCondition.wait(lLock, [this] { return !mActive; });
+		mJob	 = Job;
+		mContext = Context;
+		mCount	 = Count;
+		mNext.store(0, std::memory_order_relaxed);
+		mDone.store(0, std::memory_order_relaxed);
+		++mGeneration;
+		lLock.unlock();
+		mWorkCondition.notify_all();
+
+		WorkerPool* lPrevious = std::exchange(CurrentPool(), this);
+		Work(Job, Context, Count);
+		CurrentPool() = lPrevious;
+		lLock.lock();
+		mDoneCondition.wait(lLock, [this] { return mDone.load(std::memory_order_acquire) == mCount; });
+	}
+
+	[[nodiscard]] size_t ThreadCount() const
+	{
+		return mWorkerCount + 1;
+	}
+
+private:
+	// Pool whose job the calling thread is running, if any.
+	static WorkerPool*& CurrentPool()
+	{
+		thread_local WorkerPool* lPool{};
+		return lPool;
+	}
+
+	void Work(const job_t Job, void* Context, const size_t Count)
+	{
+		for (size_t lIndex; (lIndex = mNext.fetch_add(1, std::memory_order_relaxed)) < Count;)
+		{
+			Job(Context, lIndex);
+			mDone.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	void WorkerMain()
+	{
+		CurrentPool()		 = this;
+		uint64_t lGeneration = 0;
+		for (;;)
+		{
+			job_t  lJob;
+			void*  lContext;
+			size_t lCount;
+			{
+				std::unique_lock<std::mutex> lLock{mMutex};
+				mWorkCondition.wait(lLock, [&] { return mStop || mGeneration != lGeneration; });
+				if (mStop)
+					return;
+				lGeneration = mGeneration;
+				lJob		= mJob;
+				lContext	= mContext;
+				lCount		= mCount;
+				++mActive;
+			}
+			Work(lJob, lContext, lCount);
+			{
+				std::lock_guard<std::mutex> lLock{mMutex};
+				--mActive;
+			}
+			mDoneCondition.notify_one();
+		}
+	}
+};
+
+/**
+ * @brief Process wide pool with one worker per usable core besides the calling thread, started on first use.
+ *
+ */
+inline WorkerPool& GetWorkerPool()
+{
+	static WorkerPool lPool{[]
+							{
+								const size_t lCores = GetCpuInfo().UsableCores;
+								return lCores > 1 ? lCores - 1 : size_t{0};
+							}()};
+	return lPool;
+}
+
+/**
+ * @brief Runs Function(SliceBegin, SliceEnd) over [Begin, Begin + Size) split in one slice per pool thread.
+ *
+ * Slices start on page boundaries, so every page is first touched by a single thread and, on NUMA systems, lands on
+ * that thread's node. Ranges under BC_PARALLEL_MIN_BYTES run on the calling thread.
+ *
+ */
+template<typename T, typename TFunction>
+void ParallelForPages(T* Begin, const size_t Size, TFunction&& Function, WorkerPool& Pool = GetWorkerPool())
+{
+	const size_t lBytes	 = sizeof(T) * Size;
+	const size_t lSlices = Pool.ThreadCount();
+	if (lBytes < BC_PARALLEL_MIN_BYTES || lSlices < 2)
+	{
+		Function(Begin, Begin + Size);
+		return;
+	}
+
+	struct Context
+	{
+		T*			 Begin;
+		size_t		 Size;
+		size_t		 SliceBytes;
+		TFunction&	 Function;
+		const size_t PageMask;
+
+		// First element starting at or after the page aligned boundary of slice Slice.
+		size_t Boundary(const size_t Slice) const
+		{
+			const uintptr_t lBase	 = reinterpret_cast<uintptr_t>(Begin);
+			const uintptr_t lAddress = ((lBase + Slice * SliceBytes) + PageMask) & ~PageMask;
+			const size_t	lIndex	 = (lAddress - lBase + sizeof(T) - 1) / sizeof(T);
+			return !Slice ? 0 : lIndex < Size ? lIndex : Size;
+		}
+	};
+	const size_t lPageMask	= VirtualPageSize() - 1;
+	const size_t lSliceBytes = ((lBytes + lSlices - 1) / lSlices + lPageMask) & ~lPageMask;
+	Context		 lContext{Begin, Size, lSliceBytes, Function, lPageMask};
+	Pool.Run(
+		lSlices,
+		[](void* Value, const size_t Slice)
+		{
+			Context&	 lContext = *static_cast<Context*>(Value);
+			const size_t lFirst	  = lContext.Boundary(Slice);
+			const size_t lLast	  = lContext.Boundary(Slice + 1);
+			if (lFirst < lLast)
+				lContext.Function(lContext.Begin + lFirst, lContext.Begin + lLast);
+		},
+		&lContext);
+}
+
+template<typename T, typename... TArgs>
+void ParallelUninitializedConstruct(T* Begin, const size_t Size, const TArgs&... Args)
+{
+	ParallelForPages(Begin, Size, [&](T* SliceBegin, T* SliceEnd)
+					 { UninitializedConstruct<T*>(SliceBegin, SliceEnd, Args...); });
+}
+
+template<typename T>
+void ParallelUninitializedFill(T* Begin, const size_t Size, const T& Value)
+{
+	static_assert(std::is_copy_constructible_v<T>, "Type is not copy constructible.");
+	ParallelForPages(Begin, Size,
+					 [&](T* SliceBegin, T* SliceEnd)
+					 {
+						 while (SliceBegin < SliceEnd)
+							 new (SliceBegin++) T(Value);
+					 });
+}
+
+template<typename T>
+void ParallelDestruct(T* Begin, const size_t Size)
+{
+	if constexpr (!std::is_trivially_destructible_v<T>)
+		ParallelForPages(Begin, Size, [](T* SliceBegin, T* SliceEnd) { Destruct<T*>(SliceBegin, SliceEnd); });
+}
+
+/**
+ * @brief CreateArray constructing the elements across the worker pool, each page first touched by its constructor.
+ *
+ */
+template<typename T, typename... TArgs>
+ArrayInstance<T> CreateArrayParallel(const size_t Size, const TArgs&... Args)
+{
+	assert(Size > 0ull && "Invalid array size.");
+	T* lData = static_cast<T*>(BC_MALLOC_ALIGNED(sizeof(T) * Size, alignof(T)));
+	if (!lData)
+		return ArrayInstance<T>{nullptr, 0};
+	ParallelUninitializedConstruct(lData, Size, Args...);
+	return ArrayInstance<T>{lData, Size};
+}
+
+template<typename T>
+void DestroyArrayParallel(ArrayInstance<T>& Value)
+{
+	ParallelDestruct(Value.Value, Value.Size);
+	BC_FREE(Value.Value, sizeof(T) * Value.Size);
+	Value = ArrayInstance<T>{nullptr, 0};
+}
+
+#endif
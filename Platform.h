@@ -413,8 +413,336 @@
 #include <windows.h>
 #endif
 
-#if BC_PLATFORM_OS_DESKTOP
+// Overridable, same value on every OS so BC_MALLOC is usable outside desktop platforms too.
+#ifndef BC_PLATFORM_ALIGNMENT
 #define BC_PLATFORM_ALIGNMENT (8)
 #endif
 
+#if BC_COMPILER_MSVC
+#include <intrin.h>
+#elif BC_CPU_X86
+#include <cpuid.h>
+#endif
+
+#if BC_PLATFORM_LINUX || BC_PLATFORM_ANDROID
+#include <sched.h>
+#include <unistd.h>
+#if BC_CPU_ARM
+#include <sys/auxv.h>
+#endif
+#elif BC_PLATFORM_OSX || BC_PLATFORM_IOS
+#include <sys/sysctl.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Index of the lowest set bit, Value must not be zero.
+static BC_INLINE size_t FindFirstSet(const uint64_t Value)
+{
+#if BC_COMPILER_MSVC
+	unsigned long lIndex;
+	_BitScanForward64(&lIndex, Value);
+	return lIndex;
+#else
+	return __builtin_ctzll(Value);
+#endif
+}
+
+// Index of the highest set bit, Value must not be zero.
+static BC_INLINE size_t FindLastSet(const uint64_t Value)
+{
+#if BC_COMPILER_MSVC
+	unsigned long lIndex;
+	_BitScanReverse64(&lIndex, Value);
+	return lIndex;
+#else
+	return 63 - __builtin_clzll(Value);
+#endif
+}
+
+/**
+ * @brief Features, caches and core topology of the running machine.
+ *
+ * BC_CACHE_LINE_SIZE stays the compile time value used for layout, this is what sizing decisions (slabs, magazines,
+ * streaming thresholds, worker counts) should be based on. Fields the platform can't report are left zero, except
+ * CacheLineSize which falls back to BC_CACHE_LINE_SIZE.
+ *
+ */
+struct CpuInfo
+{
+	bool Sse42{};
+	bool Popcnt{};
+	bool Avx{};
+	bool Avx2{};
+	bool Avx512F{};
+	bool Avx512BW{};
+	bool Bmi1{};
+	bool Bmi2{};
+	bool Lzcnt{};
+	bool Neon{};
+
+	uint32_t CacheLineSize{};
+	uint32_t L1DataSize{};
+	uint32_t L2Size{};
+	uint32_t L3Size{};
+
+	uint32_t LogicalCores{};
+	uint32_t PhysicalCores{};
+	uint32_t ThreadsPerCore{};
+	// Logical cores this process may actually run on (affinity mask, cgroup cpu quota), what thread pools size from.
+	uint32_t UsableCores{};
+};
+
+#if BC_CPU_X86
+BC_INLINE void CpuId(const uint32_t Leaf, const uint32_t SubLeaf, uint32_t (&Registers)[4])
+{
+#if BC_COMPILER_MSVC
+	int lRegisters[4];
+	__cpuidex(lRegisters, static_cast<int>(Leaf), static_cast<int>(SubLeaf));
+	for (int lIndex = 0; lIndex < 4; ++lIndex)
+		Registers[lIndex] = static_cast<uint32_t>(lRegisters[lIndex]);
+#else
+	if (!__get_cpuid_count(Leaf, SubLeaf, &Registers[0], &Registers[1], &Registers[2], &Registers[3]))
+		Registers[0] = Registers[1] = Registers[2] = Registers[3] = 0;
+#endif
+}
+
+// XCR0, the register state the OS saves on context switches. AVX needs it to cover YMM, AVX-512 also ZMM and masks.
+BC_INLINE uint64_t CpuReadXcr0()
+{
+#if BC_COMPILER_MSVC
+	return _xgetbv(0);
+#else
+	uint32_t lLow, lHigh;
+	__asm__ volatile("xgetbv" : "=a"(lLow), "=d"(lHigh) : "c"(0));
+	return (static_cast<uint64_t>(lHigh) << 32) | lLow;
+#endif
+}
+
+inline void CpuDetectFeatures(CpuInfo& Info)
+{
+	uint32_t lRegisters[4];
+	CpuId(0, 0, lRegisters);
+	const uint32_t lMaxLeaf = lRegisters[0];
+	CpuId(0x80000000u, 0, lRegisters);
+	const uint32_t lMaxExtendedLeaf = lRegisters[0];
+
+	CpuId(1, 0, lRegisters);
+	Info.Sse42			 = (lRegisters[2] >> 20) & 1;
+	Info.Popcnt			 = (lRegisters[2] >> 23) & 1;
+	Info.CacheLineSize	 = ((lRegisters[1] >> 8) & 0xff) * 8;
+	const bool	   lXsave = (lRegisters[2] >> 27) & 1;
+	const uint64_t lXcr0  = lXsave ? CpuReadXcr0() : 0;
+	const bool	   lYmm	  = (lXcr0 & 0x6) == 0x6;
+	const bool	   lZmm	  = (lXcr0 & 0xe6) == 0xe6;
+	Info.Avx			 = lYmm && ((lRegisters[2] >> 28) & 1);
+
+	if (lMaxLeaf >= 7)
+	{
+		CpuId(7, 0, lRegisters);
+		Info.Bmi1	  = (lRegisters[1] >> 3) & 1;
+		Info.Avx2	  = lYmm && ((lRegisters[1] >> 5) & 1);
+		Info.Bmi2	  = (lRegisters[1] >> 8) & 1;
+		Info.Avx512F  = lZmm && ((lRegisters[1] >> 16) & 1);
+		Info.Avx512BW = lZmm && ((lRegisters[1] >> 30) & 1);
+	}
+	if (lMaxExtendedLeaf >= 0x80000001u)
+	{
+		CpuId(0x80000001u, 0, lRegisters);
+		Info.Lzcnt = (lRegisters[2] >> 5) & 1;
+	}
+}
+#else
+inline void CpuDetectFeatures(CpuInfo& Info)
+{
+#if defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+	Info.Neon = true;
+#elif BC_CPU_ARM && (BC_PLATFORM_LINUX || BC_PLATFORM_ANDROID)
+	Info.Neon = (getauxval(AT_HWCAP) >> 12) & 1; // HWCAP_NEON
+#else
+	(void)Info;
+#endif
+}
+#endif
+
+#if BC_PLATFORM_LINUX || BC_PLATFORM_ANDROID
+// Reads the first unsigned number of a sysfs file, K/M suffixes are applied. Returns zero when missing.
+inline uint64_t CpuReadSysNumber(const char* Path)
+{
+	FILE* lFile = fopen(Path, "r");
+	if (!lFile)
+		return 0;
+	unsigned long long lValue  = 0;
+	char			   lSuffix = 0;
+	const int		   lRead   = fscanf(lFile, "%llu%c", &lValue, &lSuffix);
+	fclose(lFile);
+	if (lRead < 1)
+		return 0;
+	if (lSuffix == 'K')
+		lValue <<= 10;
+	else if (lSuffix == 'M')
+		lValue <<= 20;
+	return lValue;
+}
+
+inline void CpuDetectTopology(CpuInfo& Info)
+{
+	char lPath[128];
+	for (int lIndex = 0;; ++lIndex)
+	{
+		snprintf(lPath, sizeof(lPath), "/sys/devices/system/cpu/cpu0/cache/index%d/level", lIndex);
+		const uint64_t lLevel = CpuReadSysNumber(lPath);
+		if (!lLevel)
+			break;
+		snprintf(lPath, sizeof(lPath), "/sys/devices/system/cpu/cpu0/cache/index%d/type", lIndex);
+		FILE* lFile = fopen(lPath, "r");
+		char  lType = 0;
+		if (lFile)
+		{
+			lType = static_cast<char>(fgetc(lFile));
+			fclose(lFile);
+		}
+		if (lType == 'I') // Instruction
+			continue;
+		snprintf(lPath, sizeof(lPath), "/sys/devices/system/cpu/cpu0/cache/index%d/size", lIndex);
+		const uint32_t lSize = static_cast<uint32_t>(CpuReadSysNumber(lPath));
+		if (lLevel == 1)
+		{
+			Info.L1DataSize = lSize;
+			snprintf(lPath, sizeof(lPath), "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", lIndex);
+			if (const uint64_t lLineSize = CpuReadSysNumber(lPath))
+				Info.CacheLineSize = static_cast<uint32_t>(lLineSize);
+		}
+		else if (lLevel == 2)
+			Info.L2Size = lSize;
+		else if (lLevel == 3)
+			Info.L3Size = lSize;
+	}
+
+	const long lConfigured = sysconf(_SC_NPROCESSORS_CONF);
+	const long lOnline	   = sysconf(_SC_NPROCESSORS_ONLN);
+	Info.LogicalCores	   = lOnline > 0 ? static_cast<uint32_t>(lOnline) : 0;
+	// A core is counted once, through the first logical cpu listed among its SMT siblings. Offline cpus have no
+	// topology directory and are skipped.
+	for (uint32_t lCpu = 0; lConfigured > 0 && lCpu < static_cast<uint32_t>(lConfigured); ++lCpu)
+	{
+		snprintf(lPath, sizeof(lPath), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", lCpu);
+		FILE* lFile = fopen(lPath, "r");
+		if (!lFile)
+			continue;
+		unsigned lFirst = lCpu;
+		if (fscanf(lFile, "%u", &lFirst) == 1 && lFirst == lCpu)
+			++Info.PhysicalCores;
+		fclose(lFile);
+	}
+
+	cpu_set_t lAffinity;
+	CPU_ZERO(&lAffinity);
+	Info.UsableCores = sched_getaffinity(0, sizeof(lAffinity), &lAffinity) == 0
+						   ? static_cast<uint32_t>(CPU_COUNT(&lAffinity))
+						   : Info.LogicalCores;
+	// cgroup v2 quota as seen from inside the container, "max 100000" when unlimited.
+	if (FILE* lFile = fopen("/sys/fs/cgroup/cpu.max", "r"))
+	{
+		unsigned long long lQuota = 0, lPeriod = 0;
+		if (fscanf(lFile, "%llu %llu", &lQuota, &lPeriod) == 2 && lQuota && lPeriod)
+		{
+			const uint32_t lQuotaCores = static_cast<uint32_t>((lQuota + lPeriod - 1) / lPeriod);
+			if (lQuotaCores < Info.UsableCores)
+				Info.UsableCores = lQuotaCores;
+		}
+		fclose(lFile);
+	}
+}
+#elif BC_PLATFORM_WINDOWS
+inline void CpuDetectTopology(CpuInfo& Info)
+{
+	DWORD lLength = 0;
+	GetLogicalProcessorInformation(nullptr, &lLength);
+	const DWORD							  lCount = lLength / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+	SYSTEM_LOGICAL_PROCESSOR_INFORMATION* lInfos = new SYSTEM_LOGICAL_PROCESSOR_INFORMATION[lCount ? lCount : 1];
+	if (lCount && GetLogicalProcessorInformation(lInfos, &lLength))
+	{
+		for (DWORD lIndex = 0; lIndex < lCount; ++lIndex)
+		{
+			const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& lInfo = lInfos[lIndex];
+			if (lInfo.Relationship == RelationProcessorCore)
+			{
+				++Info.PhysicalCores;
+				for (ULONG_PTR lMask = lInfo.ProcessorMask; lMask; lMask &= lMask - 1)
+					++Info.LogicalCores;
+			}
+			else if (lInfo.Relationship == RelationCache && lInfo.Cache.Type != CacheInstruction)
+			{
+				if (lInfo.Cache.Level == 1)
+				{
+					Info.L1DataSize	   = lInfo.Cache.Size;
+					Info.CacheLineSize = lInfo.Cache.LineSize;
+				}
+				else if (lInfo.Cache.Level == 2)
+					Info.L2Size = lInfo.Cache.Size;
+				else if (lInfo.Cache.Level == 3)
+					Info.L3Size = lInfo.Cache.Size;
+			}
+		}
+	}
+	delete[] lInfos;
+
+	DWORD_PTR lProcessMask = 0, lSystemMask = 0;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &lProcessMask, &lSystemMask))
+		for (; lProcessMask; lProcessMask &= lProcessMask - 1)
+			++Info.UsableCores;
+}
+#elif BC_PLATFORM_OSX || BC_PLATFORM_IOS
+inline uint32_t CpuReadSysCtl(const char* Name)
+{
+	uint64_t lValue = 0;
+	size_t	 lSize	= sizeof(lValue);
+	if (sysctlbyname(Name, &lValue, &lSize, nullptr, 0) != 0)
+		return 0;
+	return static_cast<uint32_t>(lSize == sizeof(uint32_t) ? *reinterpret_cast<uint32_t*>(&lValue) : lValue);
+}
+
+inline void CpuDetectTopology(CpuInfo& Info)
+{
+	Info.CacheLineSize = CpuReadSysCtl("hw.cachelinesize");
+	Info.L1DataSize	   = CpuReadSysCtl("hw.l1dcachesize");
+	Info.L2Size		   = CpuReadSysCtl("hw.l2cachesize");
+	Info.L3Size		   = CpuReadSysCtl("hw.l3cachesize");
+	Info.LogicalCores  = CpuReadSysCtl("hw.logicalcpu");
+	Info.PhysicalCores = CpuReadSysCtl("hw.physicalcpu");
+	Info.UsableCores   = CpuReadSysCtl("hw.activecpu");
+}
+#else
+inline void CpuDetectTopology(CpuInfo& Info)
+{
+	(void)Info;
+}
+#endif
+
+/**
+ * @brief Machine description, detected on the first call and cached.
+ *
+ */
+inline const CpuInfo& GetCpuInfo()
+{
+	static const CpuInfo lInfo = []
+	{
+		CpuInfo lResult{};
+		CpuDetectFeatures(lResult);
+		CpuDetectTopology(lResult);
+		if (!lResult.CacheLineSize)
+			lResult.CacheLineSize = BC_CACHE_LINE_SIZE;
+		if (!lResult.PhysicalCores)
+			lResult.PhysicalCores = lResult.LogicalCores;
+		lResult.ThreadsPerCore = lResult.PhysicalCores ? lResult.LogicalCores / lResult.PhysicalCores : 1;
+		if (!lResult.UsableCores || lResult.UsableCores > lResult.LogicalCores)
+			lResult.UsableCores = lResult.LogicalCores;
+		return lResult;
+	}();
+	return lInfo;
+}
+
 #endif
@@ -0,0 +1,389 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_PROFILE_H
+#define BC_PROFILE_H
+
+#include "Macros.h"
+#include "Platform.h"
+
+// Profiling is compiled out unless BC_PROFILE_ENABLED is defined to 1, the macros then expand to nothing and none of
+// the profiler, nor the standard headers it needs, is pulled in.
+#ifndef BC_PROFILE_ENABLED
+#define BC_PROFILE_ENABLED 0
+#endif
+
+#if !BC_PROFILE_ENABLED
+#define BC_PROFILE_SCOPE(NAME)
+#define BC_PROFILE_COUNTER(NAME, VALUE)
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if BC_CPU_X86
+#if BC_COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Events each thread buffers between two collections, rounded up to a power of two.
+#ifndef BC_PROFILE_THREAD_CAPACITY
+#define BC_PROFILE_THREAD_CAPACITY (1u << 16)
+#endif
+
+// Times the enclosing scope. NAME needs static storage duration, typically a string literal.
+#define BC_PROFILE_SCOPE(NAME)		   const ProfileZone BC_CONCAT(lProfileZone, __COUNTER__){NAME}
+// Records VALUE for the counter track NAME.
+#define BC_PROFILE_COUNTER(NAME, VALUE) ProfileCounter(NAME, static_cast<int64_t>(VALUE))
+
+enum class ProfileEventType : uint32_t
+{
+	Zone,
+	Counter
+};
+
+struct ProfileEvent
+{
+	const char*		 Name;
+	uint64_t		 Timestamp;
+	uint64_t		 Value; // Zone duration in ticks or counter value.
+	ProfileEventType Type;
+	uint32_t		 ThreadId;
+};
+
+/**
+ * @brief Raw profiler clock, the TSC on x86 and the steady clock elsewhere.
+ *
+ */
+BC_INLINE uint64_t ProfileTimestamp()
+{
+#if BC_CPU_X86
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Single producer single consumer event ring owned by one thread.
+ *
+ * Only the owning thread pushes, the collector drains under the registry lock. A full ring drops new events and counts
+ * them rather than blocking the instrumented code. Dropped has a single writer, so it is bumped with a relaxed load and
+ * store instead of a locked increment.
+ *
+ */
+struct ProfileThreadBuffer
+{
+	ProfileEvent*		  Events{};
+	uint64_t			  Mask{};
+	uint64_t			  TailCache{};
+	std::atomic<uint64_t> Dropped{};
+	uint32_t			  ThreadId{};
+	ProfileThreadBuffer*  Next{};
+
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<uint64_t> Head{};
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<uint64_t> Tail{};
+
+	BC_INLINE void Push(const char* Name, const uint64_t Timestamp, const uint64_t Value, const ProfileEventType Type)
+	{
+		const uint64_t lHead = Head.load(std::memory_order_relaxed);
+		if (lHead - TailCache > Mask)
+		{
+			TailCache = Tail.load(std::memory_order_acquire);
+			if (lHead - TailCache > Mask)
+			{
+				Dropped.store(Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return;
+			}
+		}
+		Events[lHead & Mask] = ProfileEvent{Name, Timestamp, Value, Type, ThreadId};
+		Head.store(lHead + 1, std::memory_order_release);
+	}
+};
+
+/**
+ * @brief Process wide list of thread buffers plus the events collected out of them.
+ *
+ * Buffers are never freed before the registry itself, so events of finished threads can still be collected.
+ *
+ */
+class ProfileRegistry
+{
+	std::mutex				  mMutex;
+	ProfileThreadBuffer*	  mBuffers{};
+	uint32_t				  mThreadCount{};
+	std::vector<ProfileEvent> mCollected;
+	uint64_t				  mDropped{};
+
+	uint64_t								  mStartTicks{ProfileTimestamp()};
+	std::chrono::steady_clock::time_point mStartTime{std::chrono::steady_clock::now()};
+
+public:
+	~ProfileRegistry()
+	{
+		while (mBuffers)
+		{
+			ProfileThreadBuffer* lNext = mBuffers->Next;
+			delete[] mBuffers->Events;
+			delete mBuffers;
+			mBuffers = lNext;
+		}
+	}
+
+public:
+	BC_NOINLINE ProfileThreadBuffer* Register()
+	{
+		ProfileThreadBuffer* lBuffer = new ProfileThreadBuffer{};
+		uint64_t			 lSize	 = 1;
+		while (lSize < BC_PROFILE_THREAD_CAPACITY)
+			lSize <<= 1;
+		lBuffer->Events				 = new ProfileEvent[lSize];
+		lBuffer->Mask				 = lSize - 1;
+		std::lock_guard<std::mutex> lLock{mMutex};
+		lBuffer->ThreadId = ++mThreadCount;
+		lBuffer->Next	  = mBuffers;
+		mBuffers		  = lBuffer;
+		return lBuffer;
+	}
+
+	/**
+	 * @brief Moves the events buffered by every thread into the collected list, freeing ring space.
+	 *
+	 * Call it regularly (e.g. once per frame) from any thread during long captures so rings don't overflow.
+	 *
+	 */
+	void Collect()
+	{
+		std::lock_guard<std::mutex> lLock{mMutex};
+		CollectLocked();
+	}
+
+	/**
+	 * @brief Collects, then writes everything captured so far as Chrome trace JSON (chrome://tracing, Perfetto).
+	 *
+	 */
+	bool WriteChromeTrace(const char* Path)
+	{
+		std::lock_guard<std::mutex> lLock{mMutex};
+		CollectLocked();
+		FILE* lFile = fopen(Path, "wb");
+		if (!lFile)
+			return false;
+		const double lMicrosecondsPerTick = MicrosecondsPerTick();
+		// Clocks of other cores can run slightly behind the registry start, so the origin is the earliest timestamp.
+		uint64_t lOrigin = mStartTicks;
+		for (const ProfileEvent& lEvent : mCollected)
+			lOrigin = std::min(lOrigin, lEvent.Timestamp);
+		fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", lFile);
+		bool lFirst = true;
+		for (const ProfileEvent& lEvent : mCollected)
+		{
+			const double lTimestamp = static_cast<double>(lEvent.Timestamp - lOrigin) * lMicrosecondsPerTick;
+			fputs(lFirst ? "" : ",\n", lFile);
+			lFirst = false;
+			fputs("{\"name\":", lFile);
+			WriteJsonString(lFile, lEvent.Name);
+			fprintf(lFile, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,", lEvent.ThreadId, lTimestamp);
+			if (lEvent.Type == ProfileEventType::Zone)
+				fprintf(lFile, "\"ph\":\"X\",\"dur\":%.3f}", static_cast<double>(lEvent.Value) * lMicrosecondsPerTick);
+			else
+				fprintf(lFile, "\"ph\":\"C\",\"args\":{\"value\":%lld}}", static_cast<long long>(lEvent.Value));
+		}
+		fprintf(lFile, "\n],\"otherData\":{\"droppedEvents\":%llu}}\n", static_cast<unsigned long long>(mDropped));
+		const bool lWritten = !ferror(lFile);
+		fclose(lFile);
+		mCollected.clear();
+		return lWritten;
+	}
+
+	/**
+	 * @brief Collects, then writes everything captured so far in the compact binary format.
+	 *
+	 * Layout, little endian: "BCPF", uint32 version, double nanoseconds per tick, uint64 dropped events, uint32 name
+	 * count then each name as uint16 length and bytes, uint64 event count then each event as uint64 timestamp, uint64
+	 * value, uint32 name index, uint16 thread id and uint16 type.
+	 *
+	 */
+	bool WriteBinary(const char* Path)
+	{
+		std::lock_guard<std::mutex> lLock{mMutex};
+		CollectLocked();
+		FILE* lFile = fopen(Path, "wb");
+		if (!lFile)
+			return false;
+
+		std::unordered_map<const char*, uint32_t> lNameIndices;
+		std::vector<const char*>				  lNames;
+		for (const ProfileEvent& lEvent : mCollected)
+		{
+			if (lNameIndices.emplace(lEvent.Name, static_cast<uint32_t>(lNames.size())).second)
+				lNames.push_back(lEvent.Name);
+		}
+
+		const uint32_t lVersion			  = 1;
+		const double   lNanosecondsPerTick = MicrosecondsPerTick() * 1000.0;
+		const uint32_t lNameCount		  = static_cast<uint32_t>(lNames.size());
+		const uint64_t lEventCount		  = mCollected.size();
+		fwrite("BCPF", 1, 4, lFile);
+		fwrite(&lVersion, sizeof(lVersion), 1, lFile);
+		fwrite(&lNanosecondsPerTick, sizeof(lNanosecondsPerTick), 1, lFile);
+		fwrite(&mDropped, sizeof(mDropped), 1, lFile);
+		fwrite(&lNameCount, sizeof(lNameCount), 1, lFile);
+		for (const char* lName : lNames)
+		{
+			const uint16_t lLength = static_cast<uint16_t>(std::min<size_t>(strlen(lName), UINT16_MAX));
+			fwrite(&lLength, sizeof(lLength), 1, lFile);
+			fwrite(lName, 1, lLength, lFile);
+		}
+		fwrite(&lEventCount, sizeof(lEventCount), 1, lFile);
+		for (const ProfileEvent& lEvent : mCollected)
+		{
+			const uint32_t lNameIndex = lNameIndices[lEvent.Name];
+			const uint16_t lThreadId  = static_cast<uint16_t>(lEvent.ThreadId);
+			const uint16_t lType	  = static_cast<uint16_t>(lEvent.Type);
+			fwrite(&lEvent.Timestamp, sizeof(lEvent.Timestamp), 1, lFile);
+			fwrite(&lEvent.Value, sizeof(lEvent.Value), 1, lFile);
+			fwrite(&lNameIndex, sizeof(lNameIndex), 1, lFile);
+			fwrite(&lThreadId, sizeof(lThreadId), 1, lFile);
+			fwrite(&lType, sizeof(lType), 1, lFile);
+		}
+		const bool lWritten = !ferror(lFile);
+		fclose(lFile);
+		mCollected.clear();
+		return lWritten;
+	}
+
+	[[nodiscard]] uint64_t Dropped()
+	{
+		std::lock_guard<std::mutex> lLock{mMutex};
+		CollectLocked();
+		return mDropped;
+	}
+
+private:
+	void CollectLocked()
+	{
+		for (ProfileThreadBuffer* lBuffer = mBuffers; lBuffer; lBuffer = lBuffer->Next)
+		{
+			const uint64_t lHead = lBuffer->Head.load(std::memory_order_acquire);
+			uint64_t	   lTail = lBuffer->Tail.load(std::memory_order_relaxed);
+			for (; lTail != lHead; ++lTail)
+				mCollected.push_back(lBuffer->Events[lTail & lBuffer->Mask]);
+			lBuffer->Tail.store(lTail, std::memory_order_release);
+		}
+		mDropped = 0;
+		for (ProfileThreadBuffer* lBuffer = mBuffers; lBuffer; lBuffer = lBuffer->Next)
+			mDropped += lBuffer->Dropped.load(std::memory_order_relaxed);
+	}
+
+	static void WriteJsonString(FILE* File, const char* String)
+	{
+		fputc('"', File);
+		for (; *String; ++String)
+		{
+			const unsigned char lChar = static_cast<unsigned char>(*String);
+			if (lChar == '"' || lChar == '\\')
+				fprintf(File, "\\%c", lChar);
+			else if (lChar < 0x20)
+				fprintf(File, "\\u%04x", lChar);
+			else
+				fputc(lChar, File);
+		}
+		fputc('"', File);
+	}
+
+	// Calibrates the raw clock against the steady clock over the time elapsed since the registry was created.
+	double MicrosecondsPerTick() const
+	{
+#if BC_CPU_X86
+		const uint64_t lTicks	  = ProfileTimestamp() - mStartTicks;
+		const auto	   lElapsed	  = std::chrono::steady_clock::now() - mStartTime;
+		const double   lMicroseconds = std::chrono::duration<double, std::micro>(lElapsed).count();
+		return lTicks ? lMicroseconds / static_cast<double>(lTicks) : 0.0;
+#else
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration{1}).count();
+#endif
+	}
+};
+
+inline ProfileRegistry& GetProfileRegistry()
+{
+	static ProfileRegistry lRegistry{};
+	return lRegistry;
+}
+
+inline thread_local ProfileThreadBuffer* tProfileThreadBuffer{};
+
+BC_INLINE ProfileThreadBuffer& GetProfileThreadBuffer()
+{
+	ProfileThreadBuffer* lBuffer = tProfileThreadBuffer;
+	if (!lBuffer)
+		lBuffer = tProfileThreadBuffer = GetProfileRegistry().Register();
+	return *lBuffer;
+}
+
+/**
+ * @brief Scope timer behind BC_PROFILE_SCOPE, emits one zone event with its start and duration when destroyed.
+ *
+ */
+class ProfileZone
+{
+	ProfileThreadBuffer& mBuffer;
+	const char*			 mName;
+	uint64_t			 mStart;
+
+public:
+	// The buffer is fetched first so the registry, and its start timestamp, exist before the first zone starts.
+	BC_INLINE BC_EXPLICIT ProfileZone(const char* Name)
+		: mBuffer{GetProfileThreadBuffer()}, mName{Name}, mStart{ProfileTimestamp()}
+	{
+	}
+	BC_INLINE ~ProfileZone()
+	{
+		const uint64_t lEnd = ProfileTimestamp();
+		mBuffer.Push(mName, mStart, lEnd - mStart, ProfileEventType::Zone);
+	}
+
+	ProfileZone(const ProfileZone&)			   = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+BC_INLINE void ProfileCounter(const char* Name, const int64_t Value)
+{
+	GetProfileThreadBuffer().Push(Name, ProfileTimestamp(), static_cast<uint64_t>(Value), ProfileEventType::Counter);
+}
+
+#endif // BC_PROFILE_ENABLED
+
+#endif
@@ -0,0 +1,260 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_QUEUE_H
+#define BC_QUEUE_H
+
+#include "Allocator.h"
+
+#include <atomic>
+#include <new>
+
+/**
+ * @brief Bounded single producer single consumer ring queue.
+ *
+ * Storage for Capacity elements (rounded up to a power of two) comes from TAllocator. Producer and consumer indices
+ * live on separate cache lines and each side keeps a cached copy of the other's index, so the shared lines are only
+ * read again when the queue looks full or empty.
+ *
+ */
+template<typename T, typename TAllocator = Mallocator>
+class SpscQueue
+{
+	TAllocator	mAllocator{};
+	MemoryBlock mData{};
+	T*			mSlots{};
+	size_t		mMask{};
+
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<size_t> mTail{};
+	size_t mHeadCache{};
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<size_t> mHead{};
+	size_t mTailCache{};
+	alignas(BC_CACHE_LINE_SIZE) uint8_t mPadding{};
+
+public:
+	BC_EXPLICIT SpscQueue(const size_t Capacity)
+	{
+		const size_t lCapacity = RoundToPowerOfTwo(Capacity);
+		mData				   = mAllocator.Allocate(sizeof(T) * lCapacity, alignof(T));
+		mSlots				   = reinterpret_cast<T*>(mData.Ptr);
+		mMask				   = lCapacity - 1;
+	}
+
+	~SpscQueue()
+	{
+		for (size_t lIndex = mHead.load(); lIndex != mTail.load(); ++lIndex)
+			mSlots[lIndex & mMask].~T();
+		if (mData.Ptr)
+			mAllocator.Deallocate(mData);
+	}
+
+	SpscQueue(const SpscQueue&)			   = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+public:
+	template<typename... TArgs>
+	bool TryEmplace(TArgs&&... Args)
+	{
+		if (!mSlots)
+			return false;
+		const size_t lTail = mTail.load(std::memory_order_relaxed);
+		if (lTail - mHeadCache > mMask)
+		{
+			mHeadCache = mHead.load(std::memory_order_acquire);
+			if (lTail - mHeadCache > mMask)
+				return false;
+		}
+		new (mSlots + (lTail & mMask)) T{std::forward<TArgs>(Args)...};
+		mTail.store(lTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPush(const T& Value)
+	{
+		return TryEmplace(Value);
+	}
+
+	bool TryPush(T&& Value)
+	{
+		return TryEmplace(std::move(Value));
+	}
+
+	bool TryPop(T& Value)
+	{
+		const size_t lHead = mHead.load(std::memory_order_relaxed);
+		if (lHead == mTailCache)
+		{
+			mTailCache = mTail.load(std::memory_order_acquire);
+			if (lHead == mTailCache)
+				return false;
+		}
+		T& lSlot = mSlots[lHead & mMask];
+		Value	 = std::move(lSlot);
+		lSlot.~T();
+		mHead.store(lHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	[[nodiscard]] size_t Capacity() const
+	{
+		return mSlots ? mMask + 1 : 0;
+	}
+};
+
+/**
+ * @brief Bounded multiple producer multiple consumer ring queue.
+ *
+ * Dmitry Vyukov's bounded queue: every cell carries a sequence number telling producers and consumers whether it is
+ * ready for them, so each operation costs a single CAS on its own index. Storage for Capacity cells (rounded up to a
+ * power of two) comes from TAllocator, and the enqueue and dequeue indices are kept on separate cache lines.
+ *
+ */
+template<typename T, typename TAllocator = Mallocator>
+class MpmcQueue
+{
+	struct Cell
+	{
+		std::atomic<size_t> Sequence;
+		alignas(T) uint8_t	Storage[sizeof(T)];
+
+		BC_INLINE T* Value()
+		{
+			return reinterpret_cast<T*>(Storage);
+		}
+	};
+
+	TAllocator	mAllocator{};
+	MemoryBlock mData{};
+	Cell*		mCells{};
+	size_t		mMask{};
+
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<size_t> mEnqueuePos{};
+	alignas(BC_CACHE_LINE_SIZE) std::atomic<size_t> mDequeuePos{};
+	alignas(BC_CACHE_LINE_SIZE) uint8_t mPadding{};
+
+public:
+	BC_EXPLICIT MpmcQueue(const size_t Capacity)
+	{
+		const size_t lCapacity = RoundToPowerOfTwo(Capacity < 2 ? 2 : Capacity);
+		mData				   = mAllocator.Allocate(sizeof(Cell) * lCapacity, alignof(Cell));
+		mCells = reinterpret_cast<Cell*>(mData.Ptr);
+		if (!mCells)
+			return;
+		mMask = lCapacity - 1;
+		for (size_t lIndex = 0; lIndex < lCapacity; ++lIndex)
+			new (&mCells[lIndex].Sequence) std::atomic<size_t>{lIndex};
+	}
+
+	~MpmcQueue()
+	{
+		for (size_t lIndex = mDequeuePos.load(); lIndex != mEnqueuePos.load(); ++lIndex)
+			mCells[lIndex & mMask].Value()->~T();
+		if (mData.Ptr)
+			mAllocator.Deallocate(mData);
+	}
+
+	MpmcQueue(const MpmcQueue&)			   = delete;
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+public:
+	template<typename... TArgs>
+	bool TryEmplace(TArgs&&... Args)
+	{
+		if (!mCells)
+			return false;
+		Cell*  lCell;
+		size_t lPos = mEnqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			lCell					   = &mCells[lPos & mMask];
+			const size_t   lSequence   = lCell->Sequence.load(std::memory_order_acquire);
+			const intptr_t lDifference = static_cast<intptr_t>(lSequence) - static_cast<intptr_t>(lPos);
+			if (lDifference == 0)
+			{
+				if (mEnqueuePos.compare_exchange_weak(lPos, lPos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (lDifference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				lPos = mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		new (lCell->Value()) T{std::forward<TArgs>(Args)...};
+		lCell->Sequence.store(lPos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPush(const T& Value)
+	{
+		return TryEmplace(Value);
+	}
+
+	bool TryPush(T&& Value)
+	{
+		return TryEmplace(std::move(Value));
+	}
+
+	bool TryPop(T& Value)
+	{
+		if (!mCells)
+			return false;
+		Cell*  lCell;
+		size_t lPos = mDequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			lCell					   = &mCells[lPos & mMask];
+			const size_t   lSequence   = lCell->Sequence.load(std::memory_order_acquire);
+			const intptr_t lDifference = static_cast<intptr_t>(lSequence) - static_cast<intptr_t>(lPos + 1);
+			if (lDifference == 0)
+			{
+				if (mDequeuePos.compare_exchange_weak(lPos, lPos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (lDifference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				lPos = mDequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+		Value = std::move(*lCell->Value());
+		lCell->Value()->~T();
+		lCell->Sequence.store(lPos + mMask + 1, std::memory_order_release);
+		return true;
+	}
+
+	[[nodiscard]] size_t Capacity() const
+	{
+		return mCells ? mMask + 1 : 0;
+	}
+};
+
+#endif
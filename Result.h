@@ -26,14 +26,28 @@
 #ifndef BC_RESULT_H
 #define BC_RESULT_H
 
+#include "Compiler.h"
+#include "Macros.h"
+
+#include <cassert>
 #include <cstdint>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 
 #define RESULT_DEFINE(SYMBOL_NAME, TYPE_NAME, DESCRIPTION, ERROR_MESSAGE)                                              \
-	constexpr ResultInfo Result##SYMBOL_NAME()                                                                         \
+	RESULT_DEFINE_WITH_CODE(SYMBOL_NAME, ResultCodeHash(#SYMBOL_NAME), TYPE_NAME, DESCRIPTION, ERROR_MESSAGE)
+
+// Same as RESULT_DEFINE with an explicit compact code. Also defines ResultCode##SYMBOL_NAME and links the result in
+// the cold registration list so ResultOf/ResultInfoOf can map the code back to it. Usable at any namespace scope, two
+// results sharing a code assert in debug builds when the second one is linked.
+#define RESULT_DEFINE_WITH_CODE(SYMBOL_NAME, CODE, TYPE_NAME, DESCRIPTION, ERROR_MESSAGE)                              \
+	constexpr result_code_t ResultCode##SYMBOL_NAME = CODE;                                                            \
+	constexpr ResultInfo	Result##SYMBOL_NAME()                                                                      \
 	{                                                                                                                  \
-		return {TYPE_NAME, DESCRIPTION, ERROR_MESSAGE};                                                                \
-	}
+		return {TYPE_NAME, DESCRIPTION, ERROR_MESSAGE, CODE};                                                          \
+	}                                                                                                                  \
+	inline ResultRegistration ResultRegistration##SYMBOL_NAME{CODE, Result##SYMBOL_NAME}
 
 #define RESULT_DEFINE_TAG(SYMBOL_NAME) RESULT_DEFINE(SYMBOL_NAME, nullptr, nullptr, nullptr)
 #define RESULT_PARAM_OPT			   result_t& Result = *(result_t*)&ResultOk
@@ -51,18 +65,33 @@
 #define RESULT_RETURN_CHECK(COND, RESULT)	\
 	if(COND) return RESULT
 
+// Evaluates an Expected returning EXPRESSION, returns its error from the enclosing function on failure and moves the
+// value into DECLARATION otherwise. Ex: RESULT_TRY(MemoryBlock lMb, TryAllocate(lAllocator, 64));
+#define RESULT_TRY(DECLARATION, EXPRESSION) RESULT_TRY_IMPL(DECLARATION, EXPRESSION, BC_CONCAT(lExpected, __COUNTER__))
+#define RESULT_TRY_IMPL(DECLARATION, EXPRESSION, NAME)                                                                 \
+	auto NAME = EXPRESSION;                                                                                            \
+	if (!NAME)                                                                                                         \
+		return Unexpected{NAME.Error()};                                                                               \
+	DECLARATION = std::move(*NAME)
+
+// Same as RESULT_TRY but only propagates the error, discarding the value.
+#define RESULT_TRY_CHECK(EXPRESSION)                                                                                   \
+	if (auto lExpected = EXPRESSION; !lExpected)                                                                       \
+	return Unexpected{lExpected.Error()}
+
 /**
  * @brief Structure that holds data information.
  *
  */
 struct ResultInfo
 {
-	constexpr ResultInfo(const char* Name, const char* Description, const char* ErrorMessage)
-		: Name{Name}, Description{Description}, ErrorMessage{ErrorMessage}
+	constexpr ResultInfo(const char* Name, const char* Description, const char* ErrorMessage, uint16_t Code = 0)
+		: Name{Name}, Description{Description}, ErrorMessage{ErrorMessage}, Code{Code}
 	{
 	}
 
 	const char *Name, *Description, *ErrorMessage;
+	uint16_t	Code;
 };
 
 /**
@@ -71,6 +100,81 @@ struct ResultInfo
  */
 using result_t = ResultInfo (*)();
 
+/**
+ * @brief Compact result code type.
+ *
+ * Every RESULT_DEFINE also defines a ResultCode##SYMBOL_NAME constant derived at compile time from the symbol name, so
+ * codes are stable across translation units, fit in packed structures and can be used as switch labels. Ok is always
+ * zero. Names and messages stay behind the cold ResultOf/ResultInfoOf lookups, hot code only compares integers.
+ *
+ */
+using result_code_t = uint16_t;
+
+constexpr result_code_t ResultCodeHash(const char* Symbol)
+{
+	// FNV-1a folded to 16 bits, zero is reserved for Ok.
+	uint32_t lHash = 2166136261u;
+	while (*Symbol)
+	{
+		lHash ^= static_cast<uint8_t>(*Symbol++);
+		lHash *= 16777619u;
+	}
+	const result_code_t lCode = static_cast<result_code_t>((lHash >> 16) ^ (lHash & 0xFFFF));
+	return lCode ? lCode : 1;
+}
+
+/**
+ * @brief Node of the list ResultOf walks, one per RESULT_DEFINE.
+ *
+ * Registering costs a couple of stores at static initialization and no table, the lookup is only paid by the cold
+ * ResultOf/ResultInfoOf paths. Debug builds also walk the list on each link to catch two results sharing a code, from
+ * any translation unit.
+ *
+ */
+struct ResultRegistration
+{
+	ResultRegistration(const result_code_t Code, const result_t Result) : Code{Code}, Result{Result}, Next{Head()}
+	{
+#ifndef NDEBUG
+		for (const ResultRegistration* lNode = Next; lNode; lNode = lNode->Next)
+			assert(lNode->Code != Code && "Result code collision, rename one of the results or give it another code.");
+#endif
+		Head() = this;
+	}
+
+	ResultRegistration(const ResultRegistration&)			 = delete;
+	ResultRegistration& operator=(const ResultRegistration&) = delete;
+
+	static ResultRegistration*& Head()
+	{
+		static ResultRegistration* lHead{};
+		return lHead;
+	}
+
+	result_code_t		Code;
+	result_t			Result;
+	ResultRegistration* Next;
+};
+
+BC_COLD inline result_t ResultOf(const result_code_t Code)
+{
+	for (const ResultRegistration* lNode = ResultRegistration::Head(); lNode; lNode = lNode->Next)
+		if (lNode->Code == Code)
+			return lNode->Result;
+	return nullptr;
+}
+
+BC_COLD inline ResultInfo ResultInfoOf(const result_code_t Code)
+{
+	const result_t lResult = ResultOf(Code);
+	return lResult ? lResult() : ResultInfo{nullptr, nullptr, nullptr, Code};
+}
+
+constexpr result_code_t ResultCodeOf(const result_t Result)
+{
+	return Result().Code;
+}
+
 /**
  * @brief Result ensure argument type.
  *
@@ -104,7 +208,7 @@ struct result_composed_t
 	result_t Other{};
 };
 
-RESULT_DEFINE(Ok, "Ok", "Result ok.", "No error.");
+RESULT_DEFINE_WITH_CODE(Ok, 0, "Ok", "Result ok.", "No error.");
 RESULT_DEFINE(ErrorFail, "ErrorFail", "Generic error fail.", "Failed. An unknown error has occurred.");
 RESULT_DEFINE(ErrorNullPtr, "ErrorNullPtr", "Error null pointer.", "Invalid pointer, it's null.");
 RESULT_DEFINE(ErrorEmptyContainer, "ErrorEmptyContainer",
@@ -127,4 +231,186 @@ RESULT_DEFINE_TAG(Arg5);
 RESULT_DEFINE_TAG(Arg6);
 RESULT_DEFINE_TAG(Arg7);
 
+/**
+ * @brief Compact result ensure argument type, same as result_composed_t using codes.
+ *
+ */
+struct result_composed_code_t
+{
+	result_code_t Result{};
+	result_code_t Other{};
+};
+
+/**
+ * @brief Ok value of each result representation.
+ *
+ */
+template<typename TError>
+struct ResultTraits;
+
+template<>
+struct ResultTraits<result_t>
+{
+	static constexpr result_t OK = ResultOk;
+};
+
+template<>
+struct ResultTraits<result_code_t>
+{
+	static constexpr result_code_t OK = ResultCodeOk;
+};
+
+/**
+ * @brief Tag selecting the error constructor of ExpectedStorage.
+ *
+ */
+struct ExpectedErrorTag
+{
+};
+
+/**
+ * @brief Error wrapper building the error side of an Expected. Ex: return Unexpected{ResultCodeErrorFail};
+ *
+ * Integral errors such as result_code_t only convert to Expected through it, so returning a small value from a
+ * function with an integral value type can't silently build an error. Converts back to the bare error so RESULT_TRY
+ * also propagates into functions returning TError itself.
+ *
+ */
+template<typename TError>
+struct Unexpected
+{
+	constexpr explicit Unexpected(const TError Error) : Error{Error}
+	{
+	}
+	constexpr operator TError() const
+	{
+		return Error;
+	}
+
+	TError Error;
+};
+
+/**
+ * @brief Storage of Expected, the value and the error side by side.
+ *
+ * Specialize it for value types with a spare state (see the MemoryBlock one in Allocator.h) so the error lives inside
+ * the value and Expected keeps the size of T.
+ *
+ */
+template<typename T, typename TError>
+struct ExpectedStorage
+{
+	static_assert(std::is_default_constructible_v<T>, "Expected value type needs to be default constructible.");
+
+	T	   Value{};
+	TError ErrorValue{ResultTraits<TError>::OK};
+
+	constexpr ExpectedStorage() = default;
+	constexpr ExpectedStorage(const T& Data) : Value{Data}
+	{
+	}
+	constexpr ExpectedStorage(T&& Data) : Value{std::move(Data)}
+	{
+	}
+	constexpr ExpectedStorage(ExpectedErrorTag, const TError Error) : ErrorValue{Error}
+	{
+	}
+	[[nodiscard]] constexpr bool HasValue() const
+	{
+		return ErrorValue == ResultTraits<TError>::OK;
+	}
+	[[nodiscard]] constexpr TError Error() const
+	{
+		return ErrorValue;
+	}
+};
+
+/**
+ * @brief Value or error return type.
+ *
+ * Holds either a T or a non-ok TError code, so fallible functions can return their result instead of writing through
+ * a RESULT_PARAM_OPT reference. It is trivially copyable whenever T is, so with T up to a pointer in size the whole
+ * object is returned in registers on the common 64-bit ABIs, as is Expected<MemoryBlock> through its ExpectedStorage
+ * specialization. Converts implicitly from any RESULT_DEFINE result, which keeps RESULT_RETURN_CHECK usable from
+ * functions returning Expected. Use result_code_t as TError for the most compact layout, its errors are passed as
+ * Unexpected{ResultCodeX} since a bare integral is always taken as the value.
+ *
+ */
+template<typename T, typename TError = result_t>
+class [[nodiscard]] Expected
+{
+	ExpectedStorage<T, TError> mStorage{};
+
+public:
+	constexpr Expected() = default;
+	constexpr Expected(const T& Value) : mStorage{Value}
+	{
+	}
+	constexpr Expected(T&& Value) : mStorage{std::move(Value)}
+	{
+	}
+	template<typename TE = TError, std::enable_if_t<!std::is_integral_v<TE>, int> = 0>
+	constexpr Expected(const TError Error) : mStorage{ExpectedErrorTag{}, Error}
+	{
+		assert(Error != ResultTraits<TError>::OK && "Expected can't be built from an ok result, pass a value instead.");
+	}
+	constexpr Expected(const Unexpected<TError> Error) : mStorage{ExpectedErrorTag{}, Error.Error}
+	{
+		assert(Error.Error != ResultTraits<TError>::OK && "Expected can't be built from an ok result.");
+	}
+
+public:
+	[[nodiscard]] constexpr bool HasValue() const
+	{
+		return mStorage.HasValue();
+	}
+	constexpr BC_EXPLICIT operator bool() const
+	{
+		return HasValue();
+	}
+	[[nodiscard]] constexpr TError Error() const
+	{
+		return mStorage.Error();
+	}
+	[[nodiscard]] constexpr T& Value() &
+	{
+		assert(HasValue() && "Expected has no value.");
+		return mStorage.Value;
+	}
+	[[nodiscard]] constexpr const T& Value() const&
+	{
+		assert(HasValue() && "Expected has no value.");
+		return mStorage.Value;
+	}
+	[[nodiscard]] constexpr T&& Value() &&
+	{
+		assert(HasValue() && "Expected has no value.");
+		return std::move(mStorage.Value);
+	}
+	[[nodiscard]] constexpr T ValueOr(T Default) const
+	{
+		return HasValue() ? mStorage.Value : Default;
+	}
+	constexpr T& operator*() &
+	{
+		return Value();
+	}
+	constexpr const T& operator*() const&
+	{
+		return Value();
+	}
+	constexpr T&& operator*() &&
+	{
+		return std::move(*this).Value();
+	}
+	constexpr T* operator->()
+	{
+		return &Value();
+	}
+	constexpr const T* operator->() const
+	{
+		return &Value();
+	}
+};
+
 #endif
@@ -0,0 +1,303 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_SMALL_VECTOR_H
+#define BC_SMALL_VECTOR_H
+
+#include "Allocator.h"
+
+#include <initializer_list>
+
+/**
+ * @brief Contiguous container keeping its first N elements inline.
+ *
+ * Storage comes from a FallbackAllocator<StackAllocator<sizeof(T) * N>, TAllocator>: the inline buffer is served by the
+ * stack tier and anything larger spills to TAllocator. Element transfers go through the UninitializedCopy and
+ * UninitializedMove family, so trivially copyable types are relocated with a single memcpy.
+ *
+ */
+template<typename T, size_t N, typename TAllocator = Mallocator>
+class SmallVector
+{
+	static_assert(N > 0, "SmallVector needs at least one inline element.");
+
+	// Rounded so the StackAllocator tier releases the inline block again once the elements spill.
+	static constexpr size_t INLINE_ALIGNMENT =
+		alignof(T) > sizeof(std::max_align_t) ? alignof(T) : sizeof(std::max_align_t);
+	static constexpr size_t INLINE_SIZE = RoundToAligned(sizeof(T) * N, INLINE_ALIGNMENT);
+
+	using allocator_t = FallbackAllocator<StackAllocator<INLINE_SIZE>, TAllocator>;
+
+	alignas(T) allocator_t mAllocator{};
+	MemoryBlock mData{};
+	size_t		mSize{};
+	size_t		mCapacity{};
+
+public:
+	SmallVector() : mData{mAllocator.Allocate(INLINE_SIZE, alignof(T))}, mCapacity{N}
+	{
+	}
+
+	SmallVector(std::initializer_list<T> Values) : SmallVector()
+	{
+		Append(Values.begin(), Values.end());
+	}
+
+	SmallVector(const SmallVector& Other) : SmallVector()
+	{
+		Append(Other.begin(), Other.end());
+	}
+
+	SmallVector(SmallVector&& Other) noexcept : SmallVector()
+	{
+		MoveFrom(Other);
+	}
+
+	~SmallVector()
+	{
+		Destruct<T*>(Data(), mSize);
+		mAllocator.Deallocate(mData);
+	}
+
+	SmallVector& operator=(const SmallVector& Other)
+	{
+		if (this != &Other)
+		{
+			Clear();
+			Append(Other.begin(), Other.end());
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Clear();
+			MoveFrom(Other);
+		}
+		return *this;
+	}
+
+public:
+	bool Reserve(const size_t Capacity)
+	{
+		if (Capacity <= mCapacity)
+			return true;
+		size_t		lCapacity{};
+		MemoryBlock lData = AllocateGrown(Capacity, lCapacity);
+		if (!lData.Ptr)
+			return false;
+		Relocate(lData, lCapacity);
+		return true;
+	}
+
+	template<typename... TArgs>
+	T& EmplaceBack(TArgs&&... Args)
+	{
+		if (mSize < mCapacity)
+			return *new (Data() + mSize++) T{std::forward<TArgs>(Args)...};
+		// Args may reference an element, so it is built in the new buffer before the old one goes away.
+		size_t		lCapacity{};
+		MemoryBlock lData = AllocateGrown(mSize + 1, lCapacity);
+		assert(lData.Ptr && "SmallVector spill allocation failed.");
+		T* lElement = new (reinterpret_cast<T*>(lData.Ptr) + mSize) T{std::forward<TArgs>(Args)...};
+		Relocate(lData, lCapacity);
+		++mSize;
+		return *lElement;
+	}
+
+	void PushBack(const T& Value)
+	{
+		EmplaceBack(Value);
+	}
+
+	void PushBack(T&& Value)
+	{
+		EmplaceBack(std::move(Value));
+	}
+
+	void PopBack()
+	{
+		assert(mSize > 0 && "Empty container.");
+		Data()[--mSize].~T();
+	}
+
+	void Append(const T* Begin, const T* End)
+	{
+		const size_t lCount = End - Begin;
+		if (mSize + lCount <= mCapacity)
+		{
+			UninitializedCopy(Begin, End, Data() + mSize);
+		}
+		else
+		{
+			// Same as EmplaceBack, the range may come from this vector.
+			size_t		lCapacity{};
+			MemoryBlock lData = AllocateGrown(mSize + lCount, lCapacity);
+			assert(lData.Ptr && "SmallVector spill allocation failed.");
+			UninitializedCopy(Begin, End, reinterpret_cast<T*>(lData.Ptr) + mSize);
+			Relocate(lData, lCapacity);
+		}
+		mSize += lCount;
+	}
+
+	template<typename... TArgs>
+	void Resize(const size_t Size, TArgs&&... Args)
+	{
+		if (Size < mSize)
+		{
+			Destruct<T*>(Data() + Size, mSize - Size);
+		}
+		else if (Size > mSize)
+		{
+			const bool lReserved = Reserve(Size);
+			assert(lReserved && "SmallVector spill allocation failed.");
+			UNUSED(lReserved);
+			UninitializedConstruct<T*>(Data() + mSize, Data() + Size, std::forward<TArgs>(Args)...);
+		}
+		mSize = Size;
+	}
+
+	void Erase(const size_t Index)
+	{
+		assert(Index < mSize && "Out of bounds.");
+		T* lData = Data();
+		for (size_t lIndex = Index; lIndex + 1 < mSize; ++lIndex)
+			lData[lIndex] = std::move(lData[lIndex + 1]);
+		PopBack();
+	}
+
+	void EraseSwap(const size_t Index)
+	{
+		assert(Index < mSize && "Out of bounds.");
+		if (Index + 1 != mSize)
+			Data()[Index] = std::move(Data()[mSize - 1]);
+		PopBack();
+	}
+
+	void Clear()
+	{
+		Destruct<T*>(Data(), mSize);
+		mSize = 0;
+	}
+
+public:
+	[[nodiscard]] size_t Size() const
+	{
+		return mSize;
+	}
+	[[nodiscard]] size_t Capacity() const
+	{
+		return mCapacity;
+	}
+	[[nodiscard]] bool Empty() const
+	{
+		return mSize == 0;
+	}
+	[[nodiscard]] bool IsInline() const
+	{
+		return mCapacity == N;
+	}
+	BC_INLINE T* Data()
+	{
+		return reinterpret_cast<T*>(mData.Ptr);
+	}
+	BC_INLINE const T* Data() const
+	{
+		return reinterpret_cast<const T*>(mData.Ptr);
+	}
+	BC_INLINE T& operator[](const size_t Index)
+	{
+		assert(Index < mSize && "Out of bounds.");
+		return Data()[Index];
+	}
+	BC_INLINE const T& operator[](const size_t Index) const
+	{
+		assert(Index < mSize && "Out of bounds.");
+		return Data()[Index];
+	}
+	BC_INLINE T& Back()
+	{
+		return (*this)[mSize - 1];
+	}
+	BC_INLINE T* begin()
+	{
+		return Data();
+	}
+	BC_INLINE T* end()
+	{
+		return Data() + mSize;
+	}
+	BC_INLINE const T* begin() const
+	{
+		return Data();
+	}
+	BC_INLINE const T* end() const
+	{
+		return Data() + mSize;
+	}
+
+private:
+	MemoryBlock AllocateGrown(const size_t Capacity, size_t& NewCapacity)
+	{
+		NewCapacity = Capacity > mCapacity * 2 ? Capacity : mCapacity * 2;
+		return mAllocator.Allocate(sizeof(T) * NewCapacity, alignof(T));
+	}
+
+	// Moves the elements into Block and releases the current buffer.
+	void Relocate(const MemoryBlock& Block, const size_t Capacity)
+	{
+		UninitializedMove<T*>(Data(), Data() + mSize, reinterpret_cast<T*>(Block.Ptr));
+		Destruct<T*>(Data(), mSize);
+		mAllocator.Deallocate(mData);
+		mData	  = Block;
+		mCapacity = Capacity;
+	}
+
+	void MoveFrom(SmallVector& Other)
+	{
+		// A spilled buffer can be stolen when the spill allocator is stateless, the inline one always has to be moved.
+		if (!Other.IsInline() && std::is_empty_v<TAllocator>)
+		{
+			mAllocator.Deallocate(mData);
+			mData			= Other.mData;
+			mSize			= Other.mSize;
+			mCapacity		= Other.mCapacity;
+			Other.mData		= Other.mAllocator.Allocate(INLINE_SIZE, alignof(T));
+			Other.mSize		= 0;
+			Other.mCapacity = N;
+			return;
+		}
+		const bool lReserved = Reserve(Other.mSize);
+		assert(lReserved && "SmallVector spill allocation failed.");
+		UNUSED(lReserved);
+		UninitializedMove<T*>(Other.Data(), Other.Data() + Other.mSize, Data());
+		mSize = Other.mSize;
+		Other.Clear();
+	}
+};
+
+#endif
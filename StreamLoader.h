@@ -0,0 +1,608 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_STREAM_LOADER_H
+#define BC_STREAM_LOADER_H
+
+#include "Allocator.h"
+#include "Queue.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+// io_uring is driven through raw syscalls, so only the kernel uapi header is needed. Define BC_STREAM_IO_URING to 0 to
+// always use the pread thread pool.
+#ifndef BC_STREAM_IO_URING
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define BC_STREAM_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef BC_STREAM_IO_URING
+#define BC_STREAM_IO_URING 0
+#endif
+
+#if BC_STREAM_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+RESULT_DEFINE(ErrorFileRead, "ErrorFileRead", "Error file read. Indicates that reading from a file failed.",
+			  "Failed. The file couldn't be read.");
+
+#if _WIN32
+using stream_file_t = HANDLE;
+#else
+using stream_file_t = int;
+#endif
+
+/**
+ * @brief Finished read handed to Dispatch callbacks or returned by Poll.
+ *
+ * Buffer is the block given by the buffer allocator, its first BytesRead bytes hold the requested range. BytesRead is
+ * only short of the requested size at end of file.
+ *
+ */
+struct StreamCompletion
+{
+	MemoryBlock Buffer{};
+	size_t		BytesRead{};
+	void*		UserData{};
+	result_t	Result{ResultOk};
+};
+
+using stream_callback_t = void (*)(StreamCompletion& Completion);
+
+enum class StreamBackend : uint8_t
+{
+	IoUring,
+	ThreadPool
+};
+
+/**
+ * @brief Asynchronous file range reader into allocator owned buffers.
+ *
+ * Submit takes a buffer from TBufferAllocator (typically a PoolAllocator or FreeListAllocator sized for the streamed
+ * chunks) and queues a read of the range straight into it. On Linux reads go through an io_uring when the kernel
+ * supports IORING_OP_READ (5.6 and later), otherwise through a pool of worker threads issuing pread (ReadFile on
+ * Windows). Completions are consumed on the submitting thread, either with Dispatch, which runs the request callback
+ * and then returns the buffer to the allocator, or with Poll, which hands buffers over until they come back through
+ * Release. Buffers and request slots are recycled, so steady state streaming allocates nothing.
+ *
+ * The buffer allocator is only touched by the thread calling Submit/Dispatch/Poll/Release, so it needs no locking.
+ * Submit fails when MaxInFlight requests are pending or the allocator is exhausted; dispatching completions frees room.
+ *
+ */
+template<typename TBufferAllocator, typename TAllocator = Mallocator>
+class StreamLoader
+{
+	static constexpr uint32_t INVALID_SLOT = ~0u;
+	// Largest read handed to one ring entry, Linux caps a single read slightly below 2 GiB anyway.
+	static constexpr size_t MAX_RING_READ = size_t{1} << 30;
+
+	struct Request
+	{
+		stream_file_t	  File{};
+		uint64_t		  Offset{};
+		MemoryBlock		  Buffer{};
+		size_t			  Size{};
+		stream_callback_t Callback{};
+		void*			  UserData{};
+		int64_t			  Read{};
+		uint32_t		  NextFree{INVALID_SLOT};
+	};
+
+#if BC_STREAM_IO_URING
+	struct Ring
+	{
+		int				mFd{-1};
+		uint32_t		mEntries{};
+		uint32_t		mUnsubmitted{};
+		uint8_t*		mSqRing{};
+		uint8_t*		mCqRing{};
+		size_t			mSqRingSize{};
+		size_t			mCqRingSize{};
+		io_uring_sqe*	mSqes{};
+		io_uring_cqe*	mCqes{};
+		uint32_t *		mSqHead{}, *mSqTail{}, *mSqMask{}, *mSqArray{};
+		uint32_t *		mCqHead{}, *mCqTail{}, *mCqMask{};
+
+		bool Init(const uint32_t Entries)
+		{
+			io_uring_params lParams{};
+			mFd = static_cast<int>(syscall(__NR_io_uring_setup, Entries, &lParams));
+			if (mFd < 0)
+				return false;
+			if (!SupportsRead())
+			{
+				Shutdown();
+				return false;
+			}
+			mEntries	= lParams.sq_entries;
+			mSqRingSize = lParams.sq_off.array + lParams.sq_entries * sizeof(uint32_t);
+			mCqRingSize = lParams.cq_off.cqes + lParams.cq_entries * sizeof(io_uring_cqe);
+			const bool lSingleMap = lParams.features & IORING_FEAT_SINGLE_MMAP;
+			if (lSingleMap)
+				mSqRingSize = mCqRingSize = mSqRingSize > mCqRingSize ? mSqRingSize : mCqRingSize;
+
+			mSqRing = MapRing(mSqRingSize, IORING_OFF_SQ_RING);
+			mCqRing = lSingleMap ? mSqRing : MapRing(mCqRingSize, IORING_OFF_CQ_RING);
+			mSqes	= reinterpret_cast<io_uring_sqe*>(
+				  MapRing(lParams.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+			if (!mSqRing || !mCqRing || !mSqes)
+			{
+				Shutdown();
+				return false;
+			}
+			mSqHead	 = reinterpret_cast<uint32_t*>(mSqRing + lParams.sq_off.head);
+			mSqTail	 = reinterpret_cast<uint32_t*>(mSqRing + lParams.sq_off.tail);
+			mSqMask	 = reinterpret_cast<uint32_t*>(mSqRing + lParams.sq_off.ring_mask);
+			mSqArray = reinterpret_cast<uint32_t*>(mSqRing + lParams.sq_off.array);
+			mCqHead	 = reinterpret_cast<uint32_t*>(mCqRing + lParams.cq_off.head);
+			mCqTail	 = reinterpret_cast<uint32_t*>(mCqRing + lParams.cq_off.tail);
+			mCqMask	 = reinterpret_cast<uint32_t*>(mCqRing + lParams.cq_off.ring_mask);
+			mCqes	 = reinterpret_cast<io_uring_cqe*>(mCqRing + lParams.cq_off.cqes);
+			return true;
+		}
+
+		void Shutdown()
+		{
+			if (mSqes)
+				munmap(mSqes, mEntries * sizeof(io_uring_sqe));
+			if (mCqRing && mCqRing != mSqRing)
+				munmap(mCqRing, mCqRingSize);
+			if (mSqRing)
+				munmap(mSqRing, mSqRingSize);
+			if (mFd >= 0)
+				close(mFd);
+			*this = Ring{};
+		}
+
+		// IORING_OP_READ and IORING_REGISTER_PROBE both came with Linux 5.6, rings of older kernels fail the probe.
+		bool SupportsRead() const
+		{
+			static constexpr uint32_t PROBE_OPS = 256;
+			alignas(io_uring_probe) uint8_t lBuffer[sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op)]{};
+			io_uring_probe* lProbe = reinterpret_cast<io_uring_probe*>(lBuffer);
+			if (syscall(__NR_io_uring_register, mFd, IORING_REGISTER_PROBE, lProbe, PROBE_OPS) < 0)
+				return false;
+			return lProbe->last_op >= IORING_OP_READ && (lProbe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+		}
+
+		uint8_t* MapRing(const size_t Size, const off_t Offset) const
+		{
+			void* lPtr = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, Offset);
+			return lPtr == MAP_FAILED ? nullptr : static_cast<uint8_t*>(lPtr);
+		}
+
+		bool Push(const int File, uint8_t* Buffer, const uint32_t Size, const uint64_t Offset, const uint64_t UserData)
+		{
+			const uint32_t lTail = *mSqTail;
+			if (lTail - __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE) >= mEntries)
+				return false;
+			const uint32_t lIndex = lTail & *mSqMask;
+			io_uring_sqe&  lSqe	  = mSqes[lIndex];
+			BC_MEMZERO(&lSqe, sizeof(lSqe));
+			lSqe.opcode		= IORING_OP_READ;
+			lSqe.fd			= File;
+			lSqe.addr		= reinterpret_cast<uint64_t>(Buffer);
+			lSqe.len		= Size;
+			lSqe.off		= Offset;
+			lSqe.user_data	= UserData;
+			mSqArray[lIndex] = lIndex;
+			__atomic_store_n(mSqTail, lTail + 1, __ATOMIC_RELEASE);
+			++mUnsubmitted;
+			return true;
+		}
+
+		// Hands pushed entries to the kernel and optionally blocks until at least one completion is posted.
+		void Enter(const bool Wait)
+		{
+			if (!mUnsubmitted && !Wait)
+				return;
+			const long lSubmitted = syscall(__NR_io_uring_enter, mFd, mUnsubmitted, Wait ? 1u : 0u,
+											Wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+			if (lSubmitted > 0)
+				mUnsubmitted -= static_cast<uint32_t>(lSubmitted);
+		}
+
+		bool Pop(uint64_t& UserData, int64_t& Res)
+		{
+			const uint32_t lHead = *mCqHead;
+			if (lHead == __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE))
+				return false;
+			const io_uring_cqe& lCqe = mCqes[lHead & *mCqMask];
+			UserData				 = lCqe.user_data;
+			Res						 = lCqe.res;
+			__atomic_store_n(mCqHead, lHead + 1, __ATOMIC_RELEASE);
+			return true;
+		}
+	};
+
+	Ring mRing{};
+#endif
+
+	TBufferAllocator& mBufferAllocator;
+	TAllocator		  mAllocator{};
+	MemoryBlock		  mRequestsBlock{};
+	Request*		  mRequests{};
+	uint32_t		  mFreeSlot{INVALID_SLOT};
+	uint32_t		  mInFlight{};
+	StreamBackend	  mBackend{StreamBackend::ThreadPool};
+
+	MpmcQueue<uint32_t, TAllocator> mPending;
+	MpmcQueue<uint32_t, TAllocator> mCompleted;
+	std::mutex						mMutex;
+	std::condition_variable			mWorkCondition;
+	std::condition_variable			mDoneCondition;
+	size_t							mQueued{};
+	std::atomic<size_t>				mDone{};
+	bool							mStop{};
+	std::thread*					mWorkers{};
+	size_t							mWorkerCount{};
+
+public:
+	/**
+	 * @brief Prefers io_uring unless ForceThreadPool is set, WorkerCount threads are only started by the fallback.
+	 *
+	 */
+	StreamLoader(TBufferAllocator& BufferAllocator, const uint32_t MaxInFlight = 64, const size_t WorkerCount = 2,
+				 const bool ForceThreadPool = false)
+		: mBufferAllocator{BufferAllocator}, mPending{MaxInFlight}, mCompleted{MaxInFlight}
+	{
+		mRequestsBlock = mAllocator.Allocate(sizeof(Request) * MaxInFlight, alignof(Request));
+		mRequests	   = reinterpret_cast<Request*>(mRequestsBlock.Ptr);
+		if (!mRequests)
+			return;
+		for (uint32_t lIndex = MaxInFlight; lIndex-- > 0;)
+		{
+			new (&mRequests[lIndex]) Request{};
+			mRequests[lIndex].NextFree = mFreeSlot;
+			mFreeSlot				   = lIndex;
+		}
+
+#if BC_STREAM_IO_URING
+		if (!ForceThreadPool && mRing.Init(MaxInFlight))
+		{
+			mBackend = StreamBackend::IoUring;
+			return;
+		}
+#else
+		UNUSED(ForceThreadPool);
+#endif
+		mWorkerCount = WorkerCount ? WorkerCount : 1;
+		mWorkers	 = new std::thread[mWorkerCount];
+		for (size_t lIndex = 0; lIndex < mWorkerCount; ++lIndex)
+			mWorkers[lIndex] = std::thread{&StreamLoader::WorkerMain, this};
+	}
+
+	~StreamLoader()
+	{
+		while (mInFlight)
+		{
+			Wait();
+			StreamCompletion lCompletion;
+			while (Poll(&lCompletion, 1))
+				Release(lCompletion.Buffer);
+		}
+		if (mWorkers)
+		{
+			{
+				std::lock_guard<std::mutex> lLock{mMutex};
+				mStop = true;
+			}
+			mWorkCondition.notify_all();
+			for (size_t lIndex = 0; lIndex < mWorkerCount; ++lIndex)
+				mWorkers[lIndex].join();
+			delete[] mWorkers;
+		}
+#if BC_STREAM_IO_URING
+		mRing.Shutdown();
+#endif
+		if (mRequestsBlock.Ptr)
+			mAllocator.Deallocate(mRequestsBlock);
+	}
+
+	StreamLoader(const StreamLoader&)			 = delete;
+	StreamLoader& operator=(const StreamLoader&) = delete;
+
+public:
+	/**
+	 * @brief Queues a read of Size bytes at Offset of File into a fresh buffer.
+	 *
+	 * Callback may be null when completions are consumed with Poll. The read is handed to the kernel or a worker before
+	 * returning, so it overlaps with whatever the caller does next. Returns false without side effects when no request
+	 * slot or buffer is available or the read couldn't be queued.
+	 *
+	 */
+	bool Submit(const stream_file_t File, const uint64_t Offset, const size_t Size,
+				stream_callback_t Callback = nullptr, void* UserData = nullptr)
+	{
+		if (mFreeSlot == INVALID_SLOT)
+			return false;
+		MemoryBlock lBuffer = mBufferAllocator.Allocate(Size);
+		if (!lBuffer.Ptr)
+			return false;
+
+		const uint32_t lSlot	= mFreeSlot;
+		Request&	   lRequest = mRequests[lSlot];
+		mFreeSlot				= lRequest.NextFree;
+		lRequest				= Request{File, Offset, lBuffer, Size, Callback, UserData};
+		++mInFlight;
+
+#if BC_STREAM_IO_URING
+		if (mBackend == StreamBackend::IoUring)
+		{
+			if (!PushRead(lSlot))
+			{
+				CancelSubmit(lSlot);
+				return false;
+			}
+			return true;
+		}
+#endif
+		if (!mPending.TryPush(lSlot))
+		{
+			CancelSubmit(lSlot);
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lLock{mMutex};
+			++mQueued;
+		}
+		mWorkCondition.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Moves up to Max finished reads into Completions without running callbacks.
+	 *
+	 * Ownership of each completion buffer passes to the caller, who gives it back with Release.
+	 *
+	 */
+	size_t Poll(StreamCompletion* Completions, const size_t Max)
+	{
+		size_t lCount = 0;
+		for (uint32_t lSlot; lCount < Max && PopCompleted(lSlot); ++lCount)
+			Completions[lCount] = Complete(lSlot);
+		return lCount;
+	}
+
+	/**
+	 * @brief Runs the callbacks of up to Max finished reads and recycles their buffers.
+	 *
+	 * A callback keeps its buffer by clearing Completion.Buffer, it then goes back through Release.
+	 *
+	 */
+	size_t Dispatch(const size_t Max = ~size_t{})
+	{
+		size_t lCount = 0;
+		for (uint32_t lSlot; lCount < Max && PopCompleted(lSlot); ++lCount)
+		{
+			stream_callback_t lCallback	  = mRequests[lSlot].Callback;
+			StreamCompletion  lCompletion = Complete(lSlot);
+			if (lCallback)
+				lCallback(lCompletion);
+			if (lCompletion.Buffer.Ptr)
+				Release(lCompletion.Buffer);
+		}
+		return lCount;
+	}
+
+	/**
+	 * @brief Blocks until at least one read has finished, returns immediately when nothing is in flight.
+	 *
+	 */
+	void Wait()
+	{
+		if (!mInFlight)
+			return;
+#if BC_STREAM_IO_URING
+		if (mBackend == StreamBackend::IoUring)
+		{
+			if (*mRing.mCqHead == __atomic_load_n(mRing.mCqTail, __ATOMIC_ACQUIRE))
+				mRing.Enter(true);
+			return;
+		}
+#endif
+		std::unique_lock<std::mutex> lLock{mMutex};
+		mDoneCondition.wait(lLock, [this] { return mDone.load(std::memory_order_relaxed) > 0; });
+	}
+
+	void Release(MemoryBlock& Buffer)
+	{
+		mBufferAllocator.Deallocate(Buffer);
+		Buffer = {};
+	}
+
+	[[nodiscard]] StreamBackend Backend() const
+	{
+		return mBackend;
+	}
+
+	[[nodiscard]] uint32_t InFlight() const
+	{
+		return mInFlight;
+	}
+
+private:
+	bool PopCompleted(uint32_t& Slot)
+	{
+#if BC_STREAM_IO_URING
+		if (mBackend == StreamBackend::IoUring)
+		{
+			mRing.Enter(false);
+			uint64_t lUserData;
+			int64_t	 lRes;
+			while (mRing.Pop(lUserData, lRes))
+			{
+				Slot			  = static_cast<uint32_t>(lUserData);
+				Request& lRequest = mRequests[Slot];
+				// Short reads are resubmitted for the remainder, only end of file or an error ends a range early.
+				if (lRes == -EINTR || lRes == -EAGAIN)
+				{
+					if (PushRead(Slot))
+						continue;
+				}
+				else if (lRes > 0)
+				{
+					lRequest.Read += lRes;
+					if (static_cast<size_t>(lRequest.Read) < lRequest.Size)
+					{
+						if (PushRead(Slot))
+							continue;
+						// The remainder couldn't be queued, fail the range rather than pass it off as end of file.
+						lRequest.Read = -EAGAIN;
+					}
+					return true;
+				}
+				if (lRes < 0)
+					lRequest.Read = lRes;
+				return true;
+			}
+			return false;
+		}
+#endif
+		if (!mCompleted.TryPop(Slot))
+			return false;
+		mDone.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+#if BC_STREAM_IO_URING
+	// Queues the part of the request not read yet, at most MAX_RING_READ bytes, and submits it right away.
+	bool PushRead(const uint32_t Slot)
+	{
+		const Request& lRequest	  = mRequests[Slot];
+		const size_t   lDone	  = static_cast<size_t>(lRequest.Read);
+		const size_t   lRemaining = lRequest.Size - lDone;
+		const uint32_t lChunk	  = static_cast<uint32_t>(lRemaining < MAX_RING_READ ? lRemaining : MAX_RING_READ);
+		if (!mRing.Push(lRequest.File, lRequest.Buffer.Ptr + lDone, lChunk, lRequest.Offset + lDone, Slot))
+		{
+			mRing.Enter(false);
+			if (!mRing.Push(lRequest.File, lRequest.Buffer.Ptr + lDone, lChunk, lRequest.Offset + lDone, Slot))
+				return false;
+		}
+		mRing.Enter(false);
+		return true;
+	}
+#endif
+
+	// Undoes a Submit whose read couldn't be queued.
+	void CancelSubmit(const uint32_t Slot)
+	{
+		Request& lRequest = mRequests[Slot];
+		Release(lRequest.Buffer);
+		lRequest.NextFree = mFreeSlot;
+		mFreeSlot		  = Slot;
+		--mInFlight;
+	}
+
+	StreamCompletion Complete(const uint32_t Slot)
+	{
+		Request&		 lRequest = mRequests[Slot];
+		StreamCompletion lCompletion{lRequest.Buffer, 0, lRequest.UserData, ResultOk};
+		if (lRequest.Read < 0)
+			lCompletion.Result = ResultErrorFileRead;
+		else
+			lCompletion.BytesRead = static_cast<size_t>(lRequest.Read);
+		lRequest.NextFree = mFreeSlot;
+		mFreeSlot		  = Slot;
+		--mInFlight;
+		return lCompletion;
+	}
+
+	void WorkerMain()
+	{
+		for (;;)
+		{
+			{
+				// Claimed under the lock, so idle workers keep sleeping while this one reads.
+				std::unique_lock<std::mutex> lLock{mMutex};
+				mWorkCondition.wait(lLock, [this] { return mStop || mQueued > 0; });
+				if (mStop)
+					return;
+				--mQueued;
+			}
+			// Submit pushes before counting, so the claimed request is already in the queue.
+			uint32_t lSlot;
+			while (!mPending.TryPop(lSlot))
+				std::this_thread::yield();
+			Request& lRequest = mRequests[lSlot];
+			lRequest.Read	  = ReadAt(lRequest.File, lRequest.Buffer.Ptr, lRequest.Size, lRequest.Offset);
+			mCompleted.TryPush(lSlot);
+			{
+				std::lock_guard<std::mutex> lLock{mMutex};
+				mDone.fetch_add(1, std::memory_order_relaxed);
+			}
+			mDoneCondition.notify_one();
+		}
+	}
+
+	// Reads the whole range unless end of file comes first, returns the byte count or a negative value on failure.
+	static int64_t ReadAt(const stream_file_t File, uint8_t* Buffer, const size_t Size, const uint64_t Offset)
+	{
+		size_t lDone = 0;
+		while (lDone < Size)
+		{
+#if _WIN32
+			OVERLAPPED lOverlapped{};
+			lOverlapped.Offset	   = static_cast<DWORD>(Offset + lDone);
+			lOverlapped.OffsetHigh = static_cast<DWORD>((Offset + lDone) >> 32);
+			DWORD lRead			   = 0;
+			const DWORD lChunk = Size - lDone > 0x40000000 ? 0x40000000 : static_cast<DWORD>(Size - lDone);
+			if (!ReadFile(File, Buffer + lDone, lChunk, &lRead, &lOverlapped))
+				return GetLastError() == ERROR_HANDLE_EOF ? static_cast<int64_t>(lDone) : -1;
+#else
+			const ssize_t lRead = pread(File, Buffer + lDone, Size - lDone, static_cast<off_t>(Offset + lDone));
+			if (lRead < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return -errno;
+			}
+#endif
+			if (lRead == 0)
+				break;
+			lDone += static_cast<size_t>(lRead);
+		}
+		return static_cast<int64_t>(lDone);
+	}
+};
+
+#endif
@@ -0,0 +1,498 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BC_TELEMETRY_H
+#define BC_TELEMETRY_H
+
+#include "Allocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <new>
+
+#if _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Sources an exporter can track, and slots of its segment.
+#ifndef BC_TELEMETRY_MAX_SLOTS
+#define BC_TELEMETRY_MAX_SLOTS 64
+#endif
+
+// Update stops publishing once no reader refreshed its heartbeat for that long.
+#ifndef BC_TELEMETRY_READER_TIMEOUT_MS
+#define BC_TELEMETRY_READER_TIMEOUT_MS 5000
+#endif
+
+RESULT_DEFINE(ErrorSharedMemoryOpen, "ErrorSharedMemoryOpen",
+			  "Error shared memory open. Indicates that a shared memory segment couldn't be created or opened.",
+			  "Failed. The shared memory segment couldn't be created or opened.");
+RESULT_DEFINE(ErrorSharedMemoryMap, "ErrorSharedMemoryMap",
+			  "Error shared memory map. Indicates that a shared memory segment couldn't be mapped or isn't valid.",
+			  "Failed. The shared memory segment couldn't be mapped or has an unexpected layout.");
+
+/**
+ * @brief Counters published for one allocator. Fields an allocator has no notion of stay zero.
+ *
+ */
+struct TelemetryCounters
+{
+	uint64_t LiveBytes;
+	uint64_t HighWaterBytes;
+	uint64_t Allocations;
+	uint64_t Deallocations;
+	uint64_t Failures;
+	uint64_t FreeListLength;
+	uint64_t Occupied;
+	uint64_t Capacity;
+};
+
+static constexpr size_t TELEMETRY_COUNTER_COUNT = sizeof(TelemetryCounters) / sizeof(uint64_t);
+
+/**
+ * @brief Shared memory layout: a header followed by SlotCapacity slots, each written under its own seqlock.
+ *
+ */
+struct TelemetryHeader
+{
+	static constexpr uint64_t MAGIC	  = 0x31454c4554434200ull; // "\0BCTELE1"
+	static constexpr uint32_t VERSION = 1;
+
+	uint64_t			  Magic;
+	uint32_t			  Version;
+	uint32_t			  SlotCapacity;
+	std::atomic<uint32_t> SlotCount;
+	uint32_t			  ProcessId;
+	// Last time, in steady clock milliseconds, a reader looked at the segment.
+	std::atomic<uint64_t> ReaderHeartbeat;
+};
+
+struct alignas(BC_CACHE_LINE_SIZE) TelemetrySlot
+{
+	std::atomic<uint32_t> Sequence; // Odd while the publisher writes Values.
+	char				  Name[60];
+	std::atomic<uint64_t> Values[TELEMETRY_COUNTER_COUNT];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Telemetry needs lock-free 64-bit atomics.");
+
+BC_INLINE uint64_t TelemetryNowMs()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+									 std::chrono::steady_clock::now().time_since_epoch())
+									 .count());
+}
+
+/**
+ * @brief Owns the mapping of a named telemetry segment, shared by the exporter and the reader.
+ *
+ */
+class TelemetrySegment
+{
+protected:
+	TelemetryHeader* mHeader{};
+	TelemetrySlot*	 mSlots{};
+	size_t			 mSize{};
+	bool			 mOwner{};
+	char			 mName[64]{};
+#if _WIN32
+	HANDLE mMapping{};
+#endif
+
+public:
+	TelemetrySegment() = default;
+	~TelemetrySegment()
+	{
+		Close();
+	}
+
+	TelemetrySegment(const TelemetrySegment&)			 = delete;
+	TelemetrySegment& operator=(const TelemetrySegment&) = delete;
+
+public:
+	void Close()
+	{
+#if _WIN32
+		if (mHeader)
+			UnmapViewOfFile(mHeader);
+		if (mMapping)
+			CloseHandle(mMapping);
+		mMapping = nullptr;
+#else
+		if (mHeader)
+			munmap(mHeader, mSize);
+		if (mOwner)
+			shm_unlink(mName);
+#endif
+		mHeader = nullptr;
+		mSlots	= nullptr;
+		mSize	= 0;
+		mOwner	= false;
+	}
+
+	[[nodiscard]] bool IsOpen() const
+	{
+		return mHeader != nullptr;
+	}
+
+protected:
+	static size_t SegmentSize(const uint32_t SlotCapacity)
+	{
+		return RoundToAligned(sizeof(TelemetryHeader), alignof(TelemetrySlot)) + sizeof(TelemetrySlot) * SlotCapacity;
+	}
+
+	// Creates the segment when SlotCapacity is set, opens an existing one otherwise.
+	result_t Map(const char* Name, const uint32_t SlotCapacity)
+	{
+		Close();
+#if _WIN32
+		snprintf(mName, sizeof(mName), "Local\\%s", Name);
+		size_t lSize = SegmentSize(SlotCapacity);
+		if (SlotCapacity)
+			mMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(lSize),
+										  mName);
+		else
+			mMapping = OpenFileMappingA(FILE_MAP_WRITE | FILE_MAP_READ, FALSE, mName);
+		RESULT_RETURN_CHECK(!mMapping, ResultErrorSharedMemoryOpen);
+		void* lData = MapViewOfFile(mMapping, FILE_MAP_WRITE | FILE_MAP_READ, 0, 0, SlotCapacity ? lSize : 0);
+		RESULT_RETURN_CHECK(!lData, (Close(), ResultErrorSharedMemoryMap));
+		if (!SlotCapacity)
+		{
+			MEMORY_BASIC_INFORMATION lInfo{};
+			VirtualQuery(lData, &lInfo, sizeof(lInfo));
+			lSize = lInfo.RegionSize;
+		}
+#else
+		snprintf(mName, sizeof(mName), Name[0] == '/' ? "%s" : "/%s", Name);
+		const int lFile = shm_open(mName, SlotCapacity ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0600);
+		RESULT_RETURN_CHECK(lFile < 0, ResultErrorSharedMemoryOpen);
+		size_t lSize = SegmentSize(SlotCapacity);
+		if (SlotCapacity && ftruncate(lFile, static_cast<off_t>(lSize)) != 0)
+		{
+			close(lFile);
+			shm_unlink(mName);
+			return ResultErrorSharedMemoryOpen;
+		}
+		if (!SlotCapacity)
+		{
+			struct stat lStat{};
+			fstat(lFile, &lStat);
+			lSize = static_cast<size_t>(lStat.st_size);
+		}
+		void* lData = lSize ? mmap(nullptr, lSize, PROT_READ | PROT_WRITE, MAP_SHARED, lFile, 0) : MAP_FAILED;
+		close(lFile);
+		if (lData == MAP_FAILED)
+		{
+			if (SlotCapacity)
+				shm_unlink(mName);
+			return ResultErrorSharedMemoryMap;
+		}
+#endif
+		mHeader = static_cast<TelemetryHeader*>(lData);
+		mSlots	= reinterpret_cast<TelemetrySlot*>(static_cast<uint8_t*>(lData) +
+												   RoundToAligned(sizeof(TelemetryHeader), alignof(TelemetrySlot)));
+		mSize	= lSize;
+		mOwner	= SlotCapacity != 0;
+		return ResultOk;
+	}
+};
+
+/**
+ * @brief Publishes the counters of tracked allocators into a named shared memory segment.
+ *
+ * Track binds a slot to any object exposing Telemetry(TelemetryCounters&) const, such as TelemetryAllocator. Call
+ * Update periodically, e.g. once per tick: while no reader refreshed the segment heartbeat within
+ * BC_TELEMETRY_READER_TIMEOUT_MS it returns after a single shared load and a clock read, otherwise every slot is
+ * written under its seqlock so readers never see a torn set of counters.
+ *
+ */
+class TelemetryExporter: public TelemetrySegment
+{
+	struct Source
+	{
+		const void* Object;
+		void (*Gather)(const void* Object, TelemetryCounters& Counters);
+	};
+
+	Source	 mSources[BC_TELEMETRY_MAX_SLOTS]{};
+	uint32_t mSourceCount{};
+
+public:
+	/**
+	 * @brief Creates, or recreates, the segment Name ("/Name" on POSIX, "Local\\Name" on Windows).
+	 *
+	 * Returns ResultOk, or the error that left the exporter closed.
+	 *
+	 */
+	[[nodiscard]] result_t Open(const char* Name)
+	{
+		mSourceCount		   = 0;
+		const result_t lResult = Map(Name, BC_TELEMETRY_MAX_SLOTS);
+		RESULT_RETURN_CHECK(lResult != ResultOk, lResult);
+		TelemetryHeader* lHeader = new (mHeader) TelemetryHeader{};
+		lHeader->Magic			 = TelemetryHeader::MAGIC;
+		lHeader->Version		 = TelemetryHeader::VERSION;
+		lHeader->SlotCapacity	 = BC_TELEMETRY_MAX_SLOTS;
+#if _WIN32
+		lHeader->ProcessId = static_cast<uint32_t>(GetCurrentProcessId());
+#else
+		lHeader->ProcessId = static_cast<uint32_t>(getpid());
+#endif
+		for (uint32_t lIndex = 0; lIndex < BC_TELEMETRY_MAX_SLOTS; ++lIndex)
+			new (&mSlots[lIndex]) TelemetrySlot{};
+		return ResultOk;
+	}
+
+	/**
+	 * @brief Publishes Object under Name from now on. Object has to outlive the exporter or Close.
+	 *
+	 */
+	template<typename TSource>
+	bool Track(const char* Name, const TSource& Object)
+	{
+		if (!mHeader || mSourceCount == BC_TELEMETRY_MAX_SLOTS)
+			return false;
+		TelemetrySlot& lSlot = mSlots[mSourceCount];
+		snprintf(lSlot.Name, sizeof(lSlot.Name), "%s", Name);
+		mSources[mSourceCount] = Source{&Object, [](const void* Value, TelemetryCounters& Counters)
+										{ static_cast<const TSource*>(Value)->Telemetry(Counters); }};
+		mHeader->SlotCount.store(++mSourceCount, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Publishes every tracked source if a reader is attached. Returns whether anything was written.
+	 *
+	 */
+	bool Update()
+	{
+		if (!mHeader || !IsObserved())
+			return false;
+		for (uint32_t lIndex = 0; lIndex < mSourceCount; ++lIndex)
+		{
+			TelemetryCounters lCounters{};
+			mSources[lIndex].Gather(mSources[lIndex].Object, lCounters);
+			Publish(mSlots[lIndex], lCounters);
+		}
+		return true;
+	}
+
+	[[nodiscard]] bool IsObserved() const
+	{
+		const uint64_t lHeartbeat = mHeader->ReaderHeartbeat.load(std::memory_order_relaxed);
+		return lHeartbeat && TelemetryNowMs() - lHeartbeat < BC_TELEMETRY_READER_TIMEOUT_MS;
+	}
+
+private:
+	static void Publish(TelemetrySlot& Slot, const TelemetryCounters& Counters)
+	{
+		uint64_t lValues[TELEMETRY_COUNTER_COUNT];
+		BC_MEMCPY(lValues, &Counters, sizeof(lValues));
+		const uint32_t lSequence = Slot.Sequence.load(std::memory_order_relaxed);
+		Slot.Sequence.store(lSequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t lIndex = 0; lIndex < TELEMETRY_COUNTER_COUNT; ++lIndex)
+			Slot.Values[lIndex].store(lValues[lIndex], std::memory_order_relaxed);
+		Slot.Sequence.store(lSequence + 2, std::memory_order_release);
+	}
+};
+
+/**
+ * @brief Attaches to a segment created by a TelemetryExporter, possibly in another process.
+ *
+ */
+class TelemetryReader: public TelemetrySegment
+{
+public:
+	/**
+	 * @brief Returns ResultOk, or the error that left the reader closed.
+	 *
+	 */
+	[[nodiscard]] result_t Open(const char* Name)
+	{
+		const result_t lResult = Map(Name, 0);
+		RESULT_RETURN_CHECK(lResult != ResultOk, lResult);
+		const bool lValid = mSize >= SegmentSize(0) && mHeader->Magic == TelemetryHeader::MAGIC &&
+							mHeader->Version == TelemetryHeader::VERSION &&
+							mSize >= SegmentSize(mHeader->SlotCapacity);
+		RESULT_RETURN_CHECK(!lValid, (Close(), ResultErrorSharedMemoryMap));
+		Heartbeat();
+		return ResultOk;
+	}
+
+	/**
+	 * @brief Tells the exporter someone is watching, call it at least every BC_TELEMETRY_READER_TIMEOUT_MS.
+	 *
+	 */
+	void Heartbeat()
+	{
+		mHeader->ReaderHeartbeat.store(TelemetryNowMs(), std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] uint32_t SlotCount() const
+	{
+		const uint32_t lCount = mHeader->SlotCount.load(std::memory_order_acquire);
+		return lCount < mHeader->SlotCapacity ? lCount : mHeader->SlotCapacity;
+	}
+
+	[[nodiscard]] uint32_t ProcessId() const
+	{
+		return mHeader->ProcessId;
+	}
+
+	[[nodiscard]] const char* SlotName(const uint32_t Index) const
+	{
+		return mSlots[Index].Name;
+	}
+
+	/**
+	 * @brief Copies a consistent snapshot of slot Index, retrying while the exporter is writing it.
+	 *
+	 */
+	bool Read(const uint32_t Index, TelemetryCounters& Counters, const uint32_t MaxRetries = 64) const
+	{
+		const TelemetrySlot& lSlot = mSlots[Index];
+		uint64_t			 lValues[TELEMETRY_COUNTER_COUNT];
+		for (uint32_t lTry = 0; lTry < MaxRetries; ++lTry)
+		{
+			const uint32_t lBegin = lSlot.Sequence.load(std::memory_order_acquire);
+			if (lBegin & 1)
+				continue;
+			for (size_t lIndex = 0; lIndex < TELEMETRY_COUNTER_COUNT; ++lIndex)
+				lValues[lIndex] = lSlot.Values[lIndex].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (lSlot.Sequence.load(std::memory_order_relaxed) != lBegin)
+				continue;
+			BC_MEMCPY(&Counters, lValues, sizeof(lValues));
+			return true;
+		}
+		return false;
+	}
+};
+
+template<typename T, typename = void>
+struct TelemetryHasFreeListLength: std::false_type
+{
+};
+
+template<typename T>
+struct TelemetryHasFreeListLength<T, std::void_t<decltype(std::declval<const T&>().FreeListLength())>>
+	: std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct TelemetryHasOccupancy: std::false_type
+{
+};
+
+template<typename T>
+struct TelemetryHasOccupancy<
+	T, std::void_t<decltype(std::declval<const T&>().Occupied()), decltype(std::declval<const T&>().Capacity())>>
+	: std::true_type
+{
+};
+
+/**
+ * @brief Allocator wrapper keeping the counters a TelemetryExporter publishes.
+ *
+ * Live and high water bytes, allocation, deallocation and failure counts are kept here. Free list length and
+ * occupancy come from the wrapped allocator when it exposes FreeListLength() or Occupied() and Capacity(), like
+ * FreeListAllocator and PoolAllocator, which keep those counts as relaxed atomics too. Every counter has a single
+ * writer, so Update may run on another thread than the one allocating.
+ *
+ */
+template<typename TAllocator>
+class TelemetryAllocator: private TAllocator
+{
+	std::atomic<uint64_t> mLiveBytes{};
+	std::atomic<uint64_t> mHighWaterBytes{};
+	std::atomic<uint64_t> mAllocations{};
+	std::atomic<uint64_t> mDeallocations{};
+	std::atomic<uint64_t> mFailures{};
+
+public:
+	static constexpr size_t MAX_ALIGNMENT = AllocatorMaxAlignment<TAllocator>::value;
+
+public:
+	using TAllocator::TAllocator;
+
+public:
+	MemoryBlock Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+	{
+		const MemoryBlock lMemoryBlock = TAllocator::Allocate(Size, Alignment);
+		if (!lMemoryBlock.Ptr)
+		{
+			SingleWriterAdd<uint64_t>(mFailures, 1);
+			return lMemoryBlock;
+		}
+		SingleWriterAdd<uint64_t>(mAllocations, 1);
+		const uint64_t lLiveBytes = SingleWriterAdd<uint64_t>(mLiveBytes, lMemoryBlock.Size);
+		if (lLiveBytes > mHighWaterBytes.load(std::memory_order_relaxed))
+			mHighWaterBytes.store(lLiveBytes, std::memory_order_relaxed);
+		return lMemoryBlock;
+	}
+
+	void Deallocate(MemoryBlock& Mb)
+	{
+		const uint64_t lSize = Mb.Size;
+		TAllocator::Deallocate(Mb);
+		Mb = {};
+		SingleWriterAdd<uint64_t>(mDeallocations, 1);
+		SingleWriterSub<uint64_t>(mLiveBytes, lSize);
+	}
+
+	[[nodiscard]] bool Owns(MemoryBlock Mb) const
+	{
+		return TAllocator::Owns(Mb);
+	}
+
+	void Telemetry(TelemetryCounters& Counters) const
+	{
+		Counters.LiveBytes		= mLiveBytes.load(std::memory_order_relaxed);
+		Counters.HighWaterBytes = mHighWaterBytes.load(std::memory_order_relaxed);
+		Counters.Allocations	= mAllocations.load(std::memory_order_relaxed);
+		Counters.Deallocations	= mDeallocations.load(std::memory_order_relaxed);
+		Counters.Failures		= mFailures.load(std::memory_order_relaxed);
+		if constexpr (TelemetryHasFreeListLength<TAllocator>::value)
+			Counters.FreeListLength = TAllocator::FreeListLength();
+		if constexpr (TelemetryHasOccupancy<TAllocator>::value)
+		{
+			Counters.Occupied = TAllocator::Occupied();
+			Counters.Capacity = TAllocator::Capacity();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Stress test for EpochDomain: readers keep dereferencing a shared node while a writer replaces and retires it.
+// Build: g++ -std=c++17 -g -fsanitize=address,undefined -I.. EpochTest.cpp -o EpochTest -pthread
+
+#include "Epoch.h"
+#include "Test.h"
+
+#include <thread>
+#include <vector>
+
+// Key and Check always hold complementary values while the node is live, its destructor clears both.
+struct Node
+{
+	std::atomic<uint64_t> Key;
+	std::atomic<uint64_t> Check;
+
+	explicit Node(const uint64_t Value) : Key{Value}, Check{~Value}
+	{
+	}
+	~Node()
+	{
+		Key.store(0, std::memory_order_relaxed);
+		Check.store(0, std::memory_order_relaxed);
+	}
+};
+
+static constexpr size_t	  POOL_CAPACITY = 256;
+static constexpr uint64_t REPLACEMENTS	= 20000;
+static constexpr size_t	  READER_COUNT	= 3;
+
+using PoolType	 = PoolAllocator<sizeof(Node), Mallocator, alignof(Node)>;
+using DomainType = EpochDomain<PoolType, READER_COUNT + 1, 16>;
+
+// The pool holds far fewer nodes than the writer allocates, so it only keeps up if retired nodes are reclaimed.
+static Node* AllocateNode(DomainType& Domain, DomainType::Participant* Thread, const uint64_t Value)
+{
+	for (size_t lTry = 0; lTry < 1000000; ++lTry)
+	{
+		const MemoryBlock lBlock = Domain.Allocate(Thread, sizeof(Node), alignof(Node));
+		if (lBlock.Ptr)
+			return new (lBlock.Ptr) Node{Value};
+		Domain.TryAdvance();
+		Domain.Collect(Thread);
+		std::this_thread::yield();
+	}
+	return nullptr;
+}
+
+static bool TestReadersNeverSeeReclaimedNodes()
+{
+	DomainType		   lDomain{POOL_CAPACITY};
+	std::atomic<Node*> lShared{};
+	std::atomic<bool>  lDone{};
+	std::atomic<bool>  lCorrupted{};
+
+	DomainType::Participant* lWriter = lDomain.Register();
+	TEST_CHECK(lWriter);
+	lShared.store(AllocateNode(lDomain, lWriter, 1), std::memory_order_release);
+
+	std::vector<std::thread> lReaders;
+	for (size_t lIndex = 0; lIndex < READER_COUNT; ++lIndex)
+	{
+		lReaders.emplace_back(
+			[&]
+			{
+				DomainType::Participant* lThread = lDomain.Register();
+				while (!lDone.load(std::memory_order_acquire))
+				{
+					DomainType::Guard lGuard{lDomain, lThread};
+					const Node*		  lNode	 = lShared.load(std::memory_order_acquire);
+					const uint64_t	  lKey	 = lNode->Key.load(std::memory_order_relaxed);
+					// Lets the writer replace and retire the node while this reader still holds it.
+					std::this_thread::yield();
+					const uint64_t lCheck = lNode->Check.load(std::memory_order_relaxed);
+					if (!lKey || lCheck != ~lKey)
+						lCorrupted.store(true, std::memory_order_relaxed);
+				}
+				lDomain.Unregister(lThread);
+			});
+	}
+
+	const uint64_t lFirstEpoch = lDomain.Epoch();
+	bool		   lAllocated  = true;
+	for (uint64_t lValue = 2; lAllocated && lValue <= REPLACEMENTS; ++lValue)
+	{
+		Node* lNode = AllocateNode(lDomain, lWriter, lValue);
+		lAllocated	= lNode != nullptr;
+		if (lAllocated)
+			lDomain.Retire(lWriter, lShared.exchange(lNode, std::memory_order_acq_rel));
+	}
+	lDone.store(true, std::memory_order_release);
+	for (std::thread& lReader : lReaders)
+		lReader.join();
+
+	TEST_CHECK(lAllocated);
+	TEST_CHECK(!lCorrupted.load());
+	TEST_CHECK(lDomain.Epoch() > lFirstEpoch);
+	lDomain.Retire(lWriter, lShared.exchange(nullptr));
+	lDomain.Unregister(lWriter);
+	return true;
+}
+
+int main()
+{
+	return TestReport(TestReadersNeverSeeReclaimedNodes());
+}
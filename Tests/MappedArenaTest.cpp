@@ -0,0 +1,87 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Tests for MappedArena creation, reopening and failure reporting.
+// Build: g++ -std=c++17 -g -fsanitize=address,undefined -I.. MappedArenaTest.cpp -o MappedArenaTest
+
+#include "MappedArena.h"
+#include "Test.h"
+
+#include <cstdio>
+
+static constexpr const char* ARENA_PATH	  = "MappedArenaTest.arena";
+static constexpr const char* INVALID_PATH = "MappedArenaTest.invalid";
+
+struct Node
+{
+	uint32_t		Value;
+	OffsetPtr<Node> Next;
+};
+
+static bool TestOpenAndCreateErrors()
+{
+	MappedArena lArena;
+	TEST_CHECK(lArena.Open("MappedArenaTest.missing/file") == ResultErrorFileOpen);
+	TEST_CHECK(lArena.Create("MappedArenaTest.missing/file", 4096) == ResultErrorFileOpen);
+	TEST_CHECK(lArena.Create(ARENA_PATH, 8) == ResultErrorOutOfBounds);
+	TEST_CHECK(!lArena.IsOpen());
+
+	std::FILE* lFile = std::fopen(INVALID_PATH, "wb");
+	TEST_CHECK(lFile);
+	std::fputs("not an arena, just some bytes long enough to hold a header", lFile);
+	std::fclose(lFile);
+	TEST_CHECK(lArena.Open(INVALID_PATH) == ResultErrorInvalidFormat);
+	TEST_CHECK(!lArena.IsOpen());
+	std::remove(INVALID_PATH);
+	return true;
+}
+
+static bool TestReopen()
+{
+	{
+		MappedArena lArena;
+		TEST_CHECK(lArena.Create(ARENA_PATH, 1 << 16) == ResultOk);
+		Node* lSecond = lArena.Construct<Node>(2u, nullptr);
+		Node* lFirst  = lArena.Construct<Node>(1u, lSecond);
+		TEST_CHECK(lFirst && lSecond);
+		lArena.SetRoot(lFirst);
+		TEST_CHECK(lArena.Flush());
+	}
+	MappedArena lArena;
+	TEST_CHECK(lArena.Open(ARENA_PATH) == ResultOk);
+	const Node* lRoot = lArena.Root<Node>();
+	TEST_CHECK(lRoot && lRoot->Value == 1 && lRoot->Next && lRoot->Next->Value == 2 && !lRoot->Next->Next);
+	lArena.Close();
+	std::remove(ARENA_PATH);
+	return true;
+}
+
+int main()
+{
+	bool lPassed = true;
+	lPassed &= TestOpenAndCreateErrors();
+	lPassed &= TestReopen();
+	return TestReport(lPassed);
+}
@@ -0,0 +1,208 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Tests for RingAllocator wrap around, full ring failures, fence driven reclamation and a consumer thread lagging
+// behind the producer.
+// Build: g++ -std=c++17 -g -fsanitize=address,undefined -I.. RingAllocatorTest.cpp -o RingAllocatorTest -pthread
+
+#include "Allocator.h"
+#include "Queue.h"
+#include "Test.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <random>
+#include <thread>
+
+static constexpr size_t RING_CAPACITY = 1024;
+
+using RingType = RingAllocator<RING_CAPACITY, Mallocator, 4>;
+
+static bool Overlaps(const MemoryBlock& First, const MemoryBlock& Second)
+{
+	return First.Ptr < Second.Ptr + Second.Size && Second.Ptr < First.Ptr + First.Size;
+}
+
+static bool TestFullRingFailsUntilReclaimed()
+{
+	RingType	lRing;
+	MemoryBlock lFirst	= lRing.Allocate(512, 16);
+	MemoryBlock lSecond = lRing.Allocate(512, 16);
+	TEST_CHECK(lFirst.Ptr == lRing.Region().Ptr && lSecond.Ptr == lFirst.Ptr + 512);
+	TEST_CHECK(lRing.Used() == RING_CAPACITY && !lRing.Allocate(1).Ptr);
+	TEST_CHECK(!lRing.Allocate(RING_CAPACITY + 1).Ptr);
+
+	TEST_CHECK(lRing.EndFrame(1));
+	TEST_CHECK(lRing.Reclaim(0) == 0 && !lRing.Allocate(1).Ptr);
+	TEST_CHECK(lRing.Reclaim(1) == RING_CAPACITY && lRing.Used() == 0 && lRing.PendingFrames() == 0);
+	const MemoryBlock lWhole = lRing.Allocate(RING_CAPACITY, 16);
+	TEST_CHECK(lWhole.Ptr == lRing.Region().Ptr);
+	return true;
+}
+
+static bool TestWrapSkipsLiveFrames()
+{
+	RingType		  lRing;
+	const MemoryBlock lFirst = lRing.Allocate(640, 16);
+	TEST_CHECK(lFirst.Ptr && lRing.EndFrame(1));
+	const MemoryBlock lSecond = lRing.Allocate(256, 16);
+	TEST_CHECK(lSecond.Ptr == lFirst.Ptr + 640 && lRing.EndFrame(2));
+	TEST_CHECK(lRing.Reclaim(1) == 640);
+
+	// 192 bytes don't fit before the end, the block wraps to the start freed by the first frame.
+	const MemoryBlock lWrapped = lRing.Allocate(192, 16);
+	TEST_CHECK(lWrapped.Ptr == lRing.Region().Ptr && !Overlaps(lWrapped, lSecond));
+	TEST_CHECK(lRing.Used() == RING_CAPACITY - 640 + 192);
+	TEST_CHECK(!lRing.Allocate(500, 16).Ptr);
+	TEST_CHECK(lRing.Reclaim(2) == 256);
+	const MemoryBlock lAfter = lRing.Allocate(500, 16);
+	TEST_CHECK(lAfter.Ptr == lWrapped.Ptr + 192);
+	return true;
+}
+
+static bool TestEndFrameLimit()
+{
+	RingType lRing;
+	for (uint64_t lFence = 1; lFence <= 4; ++lFence)
+	{
+		TEST_CHECK(lRing.Allocate(64).Ptr);
+		TEST_CHECK(lRing.EndFrame(lFence));
+	}
+	TEST_CHECK(!lRing.EndFrame(5) && lRing.PendingFrames() == 4);
+	TEST_CHECK(lRing.Reclaim(2) == 128 && lRing.EndFrame(5));
+	TEST_CHECK(lRing.Reclaim(~0ull) == 128 && lRing.Used() == 0);
+	return true;
+}
+
+struct Message
+{
+	MemoryBlock Block;
+	uint64_t	Frame;
+};
+
+static constexpr uint64_t FRAME_COUNT = 3000;
+
+// Consumer side of the frame pipeline, checks every block still holds its frame number and publishes the last frame
+// it finished as the fence the producer reclaims up to.
+static void ConsumeFrames(SpscQueue<Message>& Queue, std::atomic<uint64_t>& Completed, std::atomic<bool>& Corrupted)
+{
+	Message lMessage{};
+	for (uint64_t lFrame = 1; lFrame <= FRAME_COUNT;)
+	{
+		if (!Queue.TryPop(lMessage))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (!lMessage.Block.Ptr)
+		{
+			Completed.store(lFrame++, std::memory_order_release);
+			continue;
+		}
+		for (size_t lIndex = 0; lIndex < lMessage.Block.Size; ++lIndex)
+		{
+			if (lMessage.Block.Ptr[lIndex] != static_cast<uint8_t>(lMessage.Frame))
+				Corrupted.store(true, std::memory_order_relaxed);
+		}
+	}
+}
+
+// The producer fills blocks with their frame number while the consumer thread lags behind, so live blocks must never
+// overlap and the ring must keep wrapping into the space the completed fences released.
+static bool TestLaggingConsumer()
+{
+	RingType			  lRing;
+	SpscQueue<Message>	  lQueue{256};
+	std::atomic<uint64_t> lCompleted{};
+	std::atomic<bool>	  lCorrupted{};
+	std::thread			  lConsumer{ConsumeFrames, std::ref(lQueue), std::ref(lCompleted), std::ref(lCorrupted)};
+
+	std::mt19937		lRandom{42};
+	std::deque<Message> lLive;
+	uint64_t			lReclaimed = 0;
+	size_t				lWraps	   = 0;
+	bool				lValid	   = true;
+	const uint8_t*		lPrevious  = nullptr;
+	const auto			lReclaim   = [&]
+	{
+		lReclaimed = lCompleted.load(std::memory_order_acquire);
+		lRing.Reclaim(lReclaimed);
+		while (!lLive.empty() && lLive.front().Frame <= lReclaimed)
+			lLive.pop_front();
+	};
+	for (uint64_t lFrame = 1; lFrame <= FRAME_COUNT; ++lFrame)
+	{
+		// At most three blocks of 128 bytes aligned to 32, so a frame always fits the ring on its own, wrap included.
+		const size_t lBlockCount = 1 + lRandom() % 3;
+		for (size_t lBlock = 0; lBlock < lBlockCount; ++lBlock)
+		{
+			const size_t lSize		= 1 + lRandom() % 128;
+			const size_t lAlignment = size_t{1} << (lRandom() % 6);
+			MemoryBlock	 lMemoryBlock;
+			while (!(lMemoryBlock = lRing.Allocate(lSize, lAlignment)).Ptr)
+			{
+				std::this_thread::yield();
+				lReclaim();
+			}
+			lValid = lValid && IsAligned(lMemoryBlock.Ptr, lAlignment) && lRing.Owns(lMemoryBlock) &&
+					 lMemoryBlock.Ptr + lSize <= lRing.Region().Ptr + RING_CAPACITY;
+			for (const Message& lMessage : lLive)
+				lValid = lValid && !Overlaps(lMessage.Block, lMemoryBlock);
+			lWraps += lMemoryBlock.Ptr < lPrevious;
+			lPrevious = lMemoryBlock.Ptr;
+			BC_MEMSET(lMemoryBlock.Ptr, static_cast<uint8_t>(lFrame), lSize);
+			lLive.push_back(Message{lMemoryBlock, lFrame});
+			while (!lQueue.TryPush(lLive.back()))
+				std::this_thread::yield();
+		}
+		while (!lRing.EndFrame(lFrame))
+		{
+			std::this_thread::yield();
+			lReclaim();
+		}
+		while (!lQueue.TryPush(Message{MemoryBlock{}, lFrame}))
+			std::this_thread::yield();
+		lReclaim();
+	}
+	lConsumer.join();
+
+	TEST_CHECK(lValid);
+	TEST_CHECK(!lCorrupted.load());
+	TEST_CHECK(lWraps > 0);
+	lReclaim();
+	TEST_CHECK(lReclaimed == FRAME_COUNT && lRing.Used() == 0 && lRing.PendingFrames() == 0);
+	return true;
+}
+
+int main()
+{
+	bool lPassed = true;
+	lPassed &= TestFullRingFailsUntilReclaimed();
+	lPassed &= TestWrapSkipsLiveFrames();
+	lPassed &= TestEndFrameLimit();
+	lPassed &= TestLaggingConsumer();
+	return TestReport(lPassed);
+}
@@ -0,0 +1,95 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Regression tests for SmallVector growth when the inserted values alias its own elements, and for moved-from
+// InlineStrings.
+// Build: g++ -std=c++17 -g -fsanitize=address,undefined -I.. SmallVectorTest.cpp -o SmallVectorTest
+
+#include "InlineString.h"
+#include "Test.h"
+
+#include <string>
+
+static bool TestEmplaceBackAliasingGrow()
+{
+	SmallVector<std::string, 2> lVector{std::string(64, 'a'), std::string(64, 'b')};
+	TEST_CHECK(lVector.Size() == lVector.Capacity());
+	lVector.EmplaceBack(lVector[0]);
+	lVector.PushBack(lVector[1]);
+	TEST_CHECK(!lVector.IsInline());
+	TEST_CHECK(lVector.Size() == 4);
+	lVector.PushBack(lVector.Back());
+	TEST_CHECK(lVector[2] == std::string(64, 'a') && lVector[3] == std::string(64, 'b'));
+	TEST_CHECK(lVector.Size() == 5 && lVector.Back() == std::string(64, 'b'));
+	return true;
+}
+
+static bool TestAppendAliasingGrow()
+{
+	SmallVector<std::string, 2> lVector{std::string(64, 'a'), std::string(64, 'b')};
+	lVector.Append(lVector.begin(), lVector.end());
+	TEST_CHECK(lVector.Size() == 4);
+	lVector.Append(lVector.begin(), lVector.end());
+	TEST_CHECK(lVector.Size() == 8);
+	for (size_t lIndex = 0; lIndex < lVector.Size(); ++lIndex)
+		TEST_CHECK(lVector[lIndex] == std::string(64, lIndex % 2 ? 'b' : 'a'));
+
+	SmallVector<int, 4> lIntegers{1, 2, 3, 4};
+	lIntegers.Append(lIntegers.begin() + 1, lIntegers.end());
+	TEST_CHECK(lIntegers.Size() == 7 && lIntegers[4] == 2 && lIntegers[6] == 4);
+	return true;
+}
+
+static bool TestMovedFromInlineStringIsEmpty()
+{
+	InlineString<8> lShort{"short"};
+	InlineString<8> lShortMoved{std::move(lShort)};
+	TEST_CHECK(lShortMoved == "short");
+	TEST_CHECK(lShort.Size() == 0 && lShort.Empty() && *lShort.CStr() == '\0');
+	lShort += "again";
+	TEST_CHECK(lShort == "again");
+
+	InlineString<8> lLong{"spilled past the inline capacity"};
+	InlineString<8> lLongMoved;
+	lLongMoved = std::move(lLong);
+	TEST_CHECK(lLongMoved == "spilled past the inline capacity");
+	TEST_CHECK(lLong.Empty() && *lLong.CStr() == '\0');
+	lLong += 'x';
+	TEST_CHECK(lLong == "x");
+
+	InlineString<8>& lSelf = lLongMoved;
+	lLongMoved			   = std::move(lSelf);
+	TEST_CHECK(lLongMoved == "spilled past the inline capacity");
+	return true;
+}
+
+int main()
+{
+	bool lPassed = true;
+	lPassed &= TestEmplaceBackAliasingGrow();
+	lPassed &= TestAppendAliasingGrow();
+	lPassed &= TestMovedFromInlineStringIsEmpty();
+	return TestReport(lPassed);
+}
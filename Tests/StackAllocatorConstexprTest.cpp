@@ -0,0 +1,97 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Compile time tests for the constant evaluation path of StackAllocator::AllocateArray/DeallocateArray and the
+// Memory.h construction helpers, plus the same calls at runtime.
+// Build: g++ -std=c++20 -g -I.. StackAllocatorConstexprTest.cpp -o StackAllocatorConstexprTest
+
+#include "Allocator.h"
+#include "Test.h"
+
+#include <array>
+
+struct Entry
+{
+	int Key;
+	int Value;
+};
+
+static_assert(BC_LANGUAGE_VERSION >= BC_LANGUAGE_CPP20, "Build this test as C++20.");
+
+// Builds a squares table in stack allocated arrays and copies it out before they are released.
+constexpr std::array<Entry, 16> MakeSquares()
+{
+	StackAllocator<1024> lStack;
+	ArrayInstance<Entry> lEntries = lStack.AllocateArray<Entry>(16);
+	UninitializedConstruct(lEntries.Value, lEntries.Size, 0, 0);
+	for (size_t lIndex = 0; lIndex < lEntries.Size; ++lIndex)
+		lEntries[lIndex] = Entry{static_cast<int>(lIndex), static_cast<int>(lIndex * lIndex)};
+	std::array<Entry, 16> lResult{};
+	for (size_t lIndex = 0; lIndex < lEntries.Size; ++lIndex)
+		lResult[lIndex] = lEntries[lIndex];
+	Destruct(lEntries.Value, lEntries.Size);
+	lStack.DeallocateArray(lEntries);
+	return lResult;
+}
+
+// Capacity accounting: nested arrays charge their rounded sizes, releases rewind them and oversized requests fail.
+constexpr bool CheckAccounting()
+{
+	StackAllocator<256> lStack;
+	ArrayInstance<int> lFirst = lStack.AllocateArray<int>(10);
+	if (!lFirst || lStack.Used() != RoundToAligned(sizeof(int) * 10))
+		return false;
+	ArrayInstance<char> lSecond = lStack.AllocateArray<char>(3);
+	if (!lSecond || lStack.Used() != RoundToAligned(sizeof(int) * 10) + RoundToAligned(3))
+		return false;
+	UninitializedConstruct(lSecond.Value, lSecond.Size);
+	const bool lZeroed = lSecond[0] == 0 && lSecond[2] == 0;
+	ArrayInstance<int> lTooBig = lStack.AllocateArray<int>(256);
+	lStack.DeallocateArray(lSecond);
+	lStack.DeallocateArray(lFirst);
+	return lZeroed && !lTooBig && !lFirst && !lSecond && lStack.Used() == 0;
+}
+
+constexpr std::array<Entry, 16> SQUARES = MakeSquares();
+static_assert(SQUARES[0].Value == 0 && SQUARES[7].Key == 7 && SQUARES[15].Value == 225);
+static_assert(CheckAccounting());
+
+static bool TestRuntimeArrayUsesStackBuffer()
+{
+	StackAllocator<1024> lStack;
+	ArrayInstance<Entry> lEntries = lStack.AllocateArray<Entry>(16);
+	TEST_CHECK(lEntries && IsAligned(lEntries.Value, alignof(Entry)));
+	TEST_CHECK(lStack.Owns(MemoryBlock{reinterpret_cast<uint8_t*>(lEntries.Value), sizeof(Entry) * 16}));
+	UninitializedConstruct(lEntries.Value, lEntries.Size, 3, 4);
+	TEST_CHECK(lEntries[15].Key == 3 && lEntries[15].Value == 4);
+	lStack.DeallocateArray(lEntries);
+	TEST_CHECK(!lEntries && lStack.Used() == 0);
+	return true;
+}
+
+int main()
+{
+	return TestReport(TestRuntimeArrayUsesStackBuffer());
+}
@@ -0,0 +1,111 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Tests for telemetry segment attachment, failure reporting and publishing while another thread allocates.
+// Build: g++ -std=c++17 -g -fsanitize=address,undefined -I.. TelemetryTest.cpp -o TelemetryTest -lrt -pthread
+
+#include "Telemetry.h"
+#include "Test.h"
+
+#include <atomic>
+#include <thread>
+
+static constexpr const char* SEGMENT_NAME = "TelemetryTest";
+
+static bool TestOpenErrors()
+{
+	TelemetryReader lReader;
+	TEST_CHECK(lReader.Open("TelemetryTestMissingSegment") == ResultErrorSharedMemoryOpen);
+	TEST_CHECK(!lReader.IsOpen());
+	TelemetryExporter lExporter;
+	TEST_CHECK(lExporter.Open("TelemetryTest/Invalid/Name") != ResultOk);
+	TEST_CHECK(!lExporter.IsOpen());
+	return true;
+}
+
+static bool TestPublish()
+{
+	TelemetryAllocator<Mallocator> lAllocator;
+	TelemetryExporter			   lExporter;
+	TEST_CHECK(lExporter.Open(SEGMENT_NAME) == ResultOk);
+	TEST_CHECK(lExporter.Track("Mallocator", lAllocator));
+	MemoryBlock lBlock = lAllocator.Allocate(128);
+	TEST_CHECK(!lExporter.Update());
+
+	TelemetryReader lReader;
+	TEST_CHECK(lReader.Open(SEGMENT_NAME) == ResultOk);
+	TEST_CHECK(lExporter.Update());
+	TelemetryCounters lCounters{};
+	TEST_CHECK(lReader.SlotCount() == 1 && lReader.Read(0, lCounters));
+	TEST_CHECK(lCounters.Allocations == 1 && lCounters.LiveBytes == 128);
+	lAllocator.Deallocate(lBlock);
+	return true;
+}
+
+static bool TestPublishWhileAllocating()
+{
+	using PoolType	   = PoolAllocator<64, Mallocator>;
+	using FreeListType = FreeListAllocator<Mallocator, 64, 32, 64>;
+	TelemetryAllocator<PoolType>	 lPool{256};
+	TelemetryAllocator<FreeListType> lFreeList;
+	TelemetryExporter				 lExporter;
+	TEST_CHECK(lExporter.Open(SEGMENT_NAME) == ResultOk);
+	TEST_CHECK(lExporter.Track("Pool", lPool) && lExporter.Track("FreeList", lFreeList));
+	TelemetryReader lReader;
+	TEST_CHECK(lReader.Open(SEGMENT_NAME) == ResultOk);
+
+	// The exporter reads the pool occupancy and free list length while this thread changes them.
+	std::atomic<bool> lDone{};
+	std::thread		  lAllocating{[&]
+							  {
+								  MemoryBlock lBlocks[16]{};
+								  for (int lRound = 0; lRound < 2000; ++lRound)
+								  {
+									  for (MemoryBlock& lBlock : lBlocks)
+										  lBlock = lRound % 2 ? lPool.Allocate(64) : lFreeList.Allocate(64);
+									  for (MemoryBlock& lBlock : lBlocks)
+										  lRound % 2 ? lPool.Deallocate(lBlock) : lFreeList.Deallocate(lBlock);
+								  }
+								  lDone.store(true, std::memory_order_release);
+							  }};
+	while (!lDone.load(std::memory_order_acquire))
+		lExporter.Update();
+	lAllocating.join();
+
+	TEST_CHECK(lExporter.Update());
+	TelemetryCounters lCounters{};
+	TEST_CHECK(lReader.Read(0, lCounters) && lCounters.Occupied == 0 && lCounters.Capacity == 256);
+	TEST_CHECK(lReader.Read(1, lCounters) && lCounters.FreeListLength == 16);
+	return true;
+}
+
+int main()
+{
+	bool lPassed = true;
+	lPassed &= TestOpenErrors();
+	lPassed &= TestPublish();
+	lPassed &= TestPublishWhileAllocating();
+	return TestReport(lPassed);
+}
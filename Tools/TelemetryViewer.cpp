@@ -0,0 +1,109 @@
+/**
+ * MIT License
+ *
+ * Copyright(c) 2023 Bruno Cecconi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Live viewer for the allocator counters a TelemetryExporter publishes.
+// Build: g++ -std=c++17 -O2 -I.. TelemetryViewer.cpp -o TelemetryViewer (add -lrt on older glibc)
+// Usage: TelemetryViewer <segment name> [refresh ms] [refresh count, 0 runs until killed]
+
+#include "Telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static void PrintBytes(const uint64_t Bytes)
+{
+	static const char* UNITS[] = {"B", "KB", "MB", "GB", "TB"};
+	double			   lValue  = static_cast<double>(Bytes);
+	size_t			   lUnit   = 0;
+	while (lValue >= 1024.0 && lUnit + 1 < sizeof(UNITS) / sizeof(UNITS[0]))
+	{
+		lValue /= 1024.0;
+		++lUnit;
+	}
+	printf(" %9.1f %-2s", lValue, UNITS[lUnit]);
+}
+
+int main(const int ArgumentCount, char** Arguments)
+{
+	if (ArgumentCount < 2)
+	{
+		printf("Usage: %s <segment name> [refresh ms] [refresh count]\n", Arguments[0]);
+		return 1;
+	}
+	const uint64_t lRefreshMs = ArgumentCount > 2 ? strtoull(Arguments[2], nullptr, 10) : 1000;
+	const uint64_t lRefreshes = ArgumentCount > 3 ? strtoull(Arguments[3], nullptr, 10) : 0;
+
+	TelemetryReader lReader;
+	const result_t	lResult = lReader.Open(Arguments[1]);
+	if (lResult != ResultOk)
+	{
+		printf("%s: %s\n", Arguments[1], lResult().ErrorMessage);
+		return 1;
+	}
+
+	// The exporter only starts publishing after seeing the heartbeat, the first refresh just primes the rates.
+	TelemetryCounters lPrevious[BC_TELEMETRY_MAX_SLOTS]{};
+	std::this_thread::sleep_for(std::chrono::milliseconds(lRefreshMs));
+	lReader.Heartbeat();
+	for (uint32_t lIndex = 0; lIndex < lReader.SlotCount(); ++lIndex)
+		lReader.Read(lIndex, lPrevious[lIndex]);
+	auto lPreviousTime = std::chrono::steady_clock::now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(lRefreshMs));
+	for (uint64_t lRefresh = 0; !lRefreshes || lRefresh < lRefreshes; ++lRefresh)
+	{
+		lReader.Heartbeat();
+		const auto	 lTime	  = std::chrono::steady_clock::now();
+		const double lSeconds = std::chrono::duration<double>(lTime - lPreviousTime).count();
+		lPreviousTime		  = lTime;
+
+		printf("\npid %u, %u allocators\n", lReader.ProcessId(), lReader.SlotCount());
+		printf("%-24s %12s %12s %12s %12s %10s %10s %16s\n", "allocator", "live", "high water", "allocs/s", "frees/s",
+			   "failures", "free list", "occupancy");
+		for (uint32_t lIndex = 0; lIndex < lReader.SlotCount(); ++lIndex)
+		{
+			TelemetryCounters lCounters{};
+			if (!lReader.Read(lIndex, lCounters))
+				continue;
+			const TelemetryCounters& lLast = lPrevious[lIndex];
+			printf("%-24.24s", lReader.SlotName(lIndex));
+			PrintBytes(lCounters.LiveBytes);
+			PrintBytes(lCounters.HighWaterBytes);
+			printf(" %12.0f %12.0f %10llu %10llu", (lCounters.Allocations - lLast.Allocations) / lSeconds,
+				   (lCounters.Deallocations - lLast.Deallocations) / lSeconds,
+				   static_cast<unsigned long long>(lCounters.Failures),
+				   static_cast<unsigned long long>(lCounters.FreeListLength));
+			if (lCounters.Capacity)
+				printf(" %7llu/%-8llu", static_cast<unsigned long long>(lCounters.Occupied),
+					   static_cast<unsigned long long>(lCounters.Capacity));
+			printf("\n");
+			lPrevious[lIndex] = lCounters;
+		}
+		fflush(stdout);
+		std::this_thread::sleep_for(std::chrono::milliseconds(lRefreshMs));
+	}
+	return 0;
+}